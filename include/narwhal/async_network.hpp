@@ -1,13 +1,19 @@
 #pragma once
 
+#include <utility>
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <memory>
 #include <functional>
 #include <unordered_map>
+#include <deque>
 #include <queue>
 #include <mutex>
 #include "narwhal/consensus.hpp"
+#include "narwhal/certificate_view.hpp"
+#include "narwhal/compact_certificate.hpp"
+#include "narwhal/executor.hpp"
+#include "narwhal/write_queue.hpp"
 
 namespace narwhal::network {
 
@@ -23,7 +29,8 @@ enum class MessageType : uint8_t {
     BATCH = 0x02,
     VOTE = 0x03,
     SYNC_REQUEST = 0x04,
-    SYNC_RESPONSE = 0x05
+    SYNC_RESPONSE = 0x05,
+    COMPACT_CERTIFICATE = 0x06
 };
 
 /**
@@ -34,6 +41,7 @@ enum class MessageType : uint8_t {
 struct MessageHeader {
     static constexpr uint32_t MAGIC = 0x4E415257; // "NARW"
     static constexpr uint8_t VERSION = 0x01;
+    static constexpr size_t SIZE = 10;
     
     uint32_t magic;
     uint8_t version;
@@ -41,25 +49,64 @@ struct MessageHeader {
     uint32_t length;
     
     std::vector<uint8_t> serialize() const;
+    void serialize_into(std::span<uint8_t> out) const;
     static MessageHeader deserialize(const std::vector<uint8_t>& data);
 };
 
+/**
+ * @brief Recycles send buffers
+ *
+ * frame() serializes a message directly behind the space reserved for its
+ * MessageHeader, in a buffer owned by the pool. A buffer is reused once no
+ * write queue holds its frame any more, so a warm pool frames messages
+ * without allocating or copying.
+ */
+class BufferPool {
+public:
+    explicit BufferPool(size_t max_buffers = 256) : max_buffers_(max_buffers) {}
+
+    Frame frame(MessageType type, const utils::Serializable& message);
+
+private:
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> buffers_;
+    size_t next_ = 0;
+    size_t max_buffers_;
+};
+
 /**
  * @brief Async network connection to a peer
+ *
+ * The write queue is bounded in bytes. Past the high watermark the
+ * connection reports itself congested until it drains to the low
+ * watermark (see WriteQueue); at capacity, send() drops the message and
+ * returns false. Nothing resends it, so the caller decides whether it must
+ * be sent again. Reading pauses while
+ * the `backpressure` predicate given to start() holds, so a slow consumer
+ * pushes back on the peer through TCP instead of buffering here.
  */
 class Connection : public std::enable_shared_from_this<Connection> {
 public:
-    using MessageHandler = std::function<void(MessageType, std::vector<uint8_t>)>;
-    
-    Connection(asio::io_context& io_context, ssl::context& ssl_context);
+    // The payload aliases the read buffer and is only valid during the call.
+    using MessageHandler = std::function<void(MessageType, std::span<const uint8_t>)>;
+    using Backpressure = std::function<bool()>;
+
+    Connection(asio::io_context& io_context, ssl::context& ssl_context, WriteLimits limits = {});
     
-    tcp::socket& socket() { return socket_.lowest_layer(); }
+    ssl::stream<tcp::socket>::lowest_layer_type& socket() { return socket_.lowest_layer(); }
     
-    void start(MessageHandler handler);
-    void send(MessageType type, const std::vector<uint8_t>& payload);
+    void start(MessageHandler handler, Backpressure backpressure = {});
+    // Returns false if the message was dropped because the write queue is full.
+    bool send(MessageType type, const std::vector<uint8_t>& payload);
+    bool send(Frame frame);
     void close();
+
+    bool congested() const { return write_queue_.congested(); }
+    size_t queued_bytes() const;
     
 private:
+    static constexpr std::chrono::milliseconds READ_PAUSE{1};
+
     void do_handshake();
     void do_read_header();
     void do_read_body(const MessageHeader& header);
@@ -67,10 +114,12 @@ private:
     
     ssl::stream<tcp::socket> socket_;
     MessageHandler message_handler_;
+    Backpressure backpressure_;
+    asio::steady_timer read_pause_;
     
     std::vector<uint8_t> read_buffer_;
-    std::queue<std::vector<uint8_t>> write_queue_;
-    std::mutex write_mutex_;
+    WriteQueue write_queue_;
+    mutable std::mutex write_mutex_;
 };
 
 /**
@@ -85,14 +134,32 @@ private:
 class AsyncNetwork {
 public:
     using CertificateHandler = std::function<void(const consensus::Certificate&)>;
+    // Runs on the io thread against the receive buffer; certificates it
+    // rejects are dropped before anything is allocated for them.
+    using CertificateFilter = std::function<bool(const consensus::CertificateView&)>;
     
     struct Config {
         uint16_t listen_port;
         std::string cert_file;
         std::string key_file;
         size_t io_threads = 4;
+        // Applied to each io thread as it starts.
+        config::Placement io_placement;
+        WriteLimits write_limits;
+        // While this returns true, connections stop reading from their peers.
+        Connection::Backpressure backpressure;
         size_t max_connections = 100;
         std::chrono::seconds reconnect_interval{5};
+        // When set, accepted certificates are delivered as tasks on this
+        // executor; the io threads only read, parse and filter.
+        utils::Executor* executor = nullptr;
+        // When set, certificates go out as CompactCertificate with parents
+        // resolved against this table. Inbound certificates are not recorded
+        // here: whoever verifies them does (see Verifier). A compact
+        // certificate whose parents it cannot resolve, or that expands to
+        // the wrong digest, is answered with a SYNC_REQUEST for the full
+        // encoding.
+        consensus::SlotTable* parent_slots = nullptr;
     };
     
     explicit AsyncNetwork(const Config& config);
@@ -104,18 +171,27 @@ public:
     // Stop the network layer (blocking until all connections close)
     void stop();
     
-    // Send a certificate to a specific peer
-    void send_certificate(const std::string& peer_address, 
+    // Send a certificate to a specific peer. Returns false if the peer is
+    // unknown or its write queue is at capacity; a dropped certificate is
+    // not resent, so a caller that needs it delivered sends it again once
+    // congested() clears.
+    bool send_certificate(const std::string& peer_address, 
                          const consensus::Certificate& cert);
     
-    // Broadcast a certificate to all known peers
-    void broadcast_certificate(const consensus::Certificate& cert);
+    // Broadcast a certificate to all known peers. Returns how many peers
+    // it was queued for; the others dropped it at capacity, as above.
+    size_t broadcast_certificate(const consensus::Certificate& cert);
     
-    // Register handler for incoming certificates
-    void on_certificate(CertificateHandler handler);
+    // Register handler for incoming certificates, and optionally a filter
+    // that decides which ones are worth materializing.
+    void on_certificate(CertificateHandler handler, CertificateFilter filter = {});
     
     // Add a peer to the known peers list
     void add_peer(const std::string& address);
+
+    // Whether any peer's write queue is above its high watermark; proposers
+    // should hold back until it clears.
+    bool congested() const;
     
     // Get network statistics
     struct Stats {
@@ -124,14 +200,22 @@ public:
         size_t messages_received;
         size_t bytes_sent;
         size_t bytes_received;
+        size_t messages_dropped;      // write queue at capacity
+        size_t certificates_filtered; // rejected by the certificate filter
+        size_t sync_requests;         // compact certificates we could not resolve
+        size_t write_queue_bytes;     // summed over connections, at the time of the call
+        size_t congested_connections;
     };
     Stats get_stats() const;
     
 private:
     void do_accept();
     void connect_to_peer(const std::string& address);
-    void handle_message(const std::string& peer, MessageType type, 
-                       const std::vector<uint8_t>& data);
+    void handle_message(Connection& from, MessageType type, std::span<const uint8_t> data);
+    void handle_certificate(std::span<const uint8_t> data);
+    void handle_sync_request(Connection& from, std::span<const uint8_t> data);
+    // The frame a certificate is sent as: compact if parent_slots is set.
+    Frame encode(const consensus::Certificate& cert);
     
     Config config_;
     asio::io_context io_context_;
@@ -141,9 +225,23 @@ private:
     
     std::vector<std::thread> io_threads_;
     std::unordered_map<std::string, std::shared_ptr<Connection>> connections_;
-    std::mutex connections_mutex_;
+    mutable std::mutex connections_mutex_;
     
+    BufferPool send_buffers_;
+
+    // Compact certificates we sent recently, kept to answer SYNC_REQUESTs.
+    // The frames stay out of the pool while held, so this stays well under
+    // its size.
+    struct Sent {
+        crypto::PublicKey author;
+        consensus::Round round;
+        Frame frame;
+    };
+    static constexpr size_t RECENT_CAPACITY = 64;
+    std::deque<Sent> recent_;
+    std::mutex recent_mutex_;
     CertificateHandler certificate_handler_;
+    CertificateFilter certificate_filter_;
     
     // Statistics
     mutable std::mutex stats_mutex_;
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace narwhal::utils {
+
+/**
+ * @brief Word kernels over 64-bit bitmaps.
+ *
+ * Plain loops over contiguous words, written so the compiler vectorizes them
+ * (SSE/AVX/NEON depending on the target flags).
+ */
+namespace bits {
+
+inline size_t words_for(size_t bits) { return (bits + 63) / 64; }
+
+inline bool test(std::span<const uint64_t> words, size_t i) {
+    return (words[i / 64] >> (i % 64)) & 1;
+}
+
+inline void set(std::span<uint64_t> words, size_t i) {
+    words[i / 64] |= uint64_t{1} << (i % 64);
+}
+
+inline void or_into(std::span<uint64_t> dst, std::span<const uint64_t> src) {
+    for (size_t i = 0; i < dst.size(); ++i) dst[i] |= src[i];
+}
+
+inline void and_into(std::span<uint64_t> dst, std::span<const uint64_t> src) {
+    for (size_t i = 0; i < dst.size(); ++i) dst[i] &= src[i];
+}
+
+inline bool any(std::span<const uint64_t> words) {
+    uint64_t acc = 0;
+    for (auto w : words) acc |= w;
+    return acc != 0;
+}
+
+inline size_t count(std::span<const uint64_t> words) {
+    size_t n = 0;
+    for (auto w : words) n += std::popcount(w);
+    return n;
+}
+
+// Calls f(index) for every set bit, in increasing order.
+template<typename F>
+void for_each(std::span<const uint64_t> words, F&& f) {
+    for (size_t i = 0; i < words.size(); ++i) {
+        for (uint64_t w = words[i]; w != 0; w &= w - 1) {
+            f(i * 64 + std::countr_zero(w));
+        }
+    }
+}
+
+} // namespace bits
+
+// Owning fixed-width bitmap.
+class Bitmap {
+public:
+    Bitmap() = default;
+    explicit Bitmap(size_t size) : size_(size), words_(bits::words_for(size)) {}
+
+    size_t size() const { return size_; }
+    bool test(size_t i) const { return bits::test(words_, i); }
+    void set(size_t i) { bits::set(words_, i); }
+    void clear() { std::fill(words_.begin(), words_.end(), 0); }
+    bool any() const { return bits::any(words_); }
+    size_t count() const { return bits::count(words_); }
+
+    Bitmap& operator|=(std::span<const uint64_t> other) { bits::or_into(words_, other); return *this; }
+    Bitmap& operator&=(std::span<const uint64_t> other) { bits::and_into(words_, other); return *this; }
+
+    std::span<const uint64_t> words() const { return words_; }
+    std::span<uint64_t> words() { return words_; }
+
+    bool operator==(const Bitmap&) const = default;
+
+    template<typename F>
+    void for_each(F&& f) const { bits::for_each(words_, std::forward<F>(f)); }
+
+private:
+    size_t size_ = 0;
+    std::vector<uint64_t> words_;
+};
+
+} // namespace narwhal::utils
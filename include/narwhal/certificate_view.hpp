@@ -0,0 +1,144 @@
+#pragma once
+
+#include "narwhal/consensus_engines.hpp"
+#include <mutex>
+
+namespace narwhal::consensus {
+
+/**
+ * @brief Read-only view of an encoded Header.
+ *
+ * Construction walks the encoding once, checking every length prefix
+ * against the input and that the payload is in canonical order. Accessors
+ * then read fields straight from the bytes without allocating. The view
+ * does not own its bytes.
+ */
+class HeaderView {
+public:
+    // Throws std::runtime_error if the encoding is malformed or truncated.
+    static HeaderView parse(utils::Unpacker& unpacker);
+
+    crypto::PublicKey author() const { return read<crypto::PublicKey>(0); }
+    Round round() const { return round_; }
+
+    size_t parent_count() const { return parent_count_; }
+    crypto::Digest parent(size_t i) const { return read<crypto::Digest>(PARENTS + i * sizeof(crypto::Digest)); }
+
+    size_t payload_count() const { return payload_count_; }
+    Payload::Entry payload(size_t i) const {
+        const size_t offset = payload_offset_ + i * PAYLOAD_ENTRY;
+        return {read<crypto::Digest>(offset), static_cast<WorkerId>(utils::load_u64(bytes_.data() + offset + sizeof(crypto::Digest)))};
+    }
+
+    // The encoded header; its hash is the certificate digest.
+    std::span<const uint8_t> bytes() const { return bytes_; }
+    crypto::Digest digest() const { return crypto::Hash::compute(bytes_); }
+
+    Header materialize() const;
+
+private:
+    // author, round, parent count
+    static constexpr size_t PARENTS = sizeof(crypto::PublicKey) + 8 + 8;
+    static constexpr size_t PAYLOAD_ENTRY = sizeof(crypto::Digest) + 8;
+
+    template<typename Array>
+    Array read(size_t offset) const {
+        Array value;
+        std::memcpy(value.data(), bytes_.data() + offset, value.size());
+        return value;
+    }
+
+    std::span<const uint8_t> bytes_;
+    Round round_ = 0;
+    size_t parent_count_ = 0;
+    size_t payload_count_ = 0;
+    size_t payload_offset_ = 0;
+};
+
+/**
+ * @brief Read-only view of an encoded Certificate.
+ *
+ * Lets the inbound path inspect a certificate in the receive buffer and
+ * drop it (duplicate, stale, unknown author) before anything is
+ * allocated. materialize() makes the owned Certificate once it is accepted.
+ */
+class CertificateView {
+public:
+    // Throws std::runtime_error if `data` is not exactly one encoded certificate.
+    static CertificateView parse(std::span<const uint8_t> data);
+    static CertificateView parse(utils::Unpacker& unpacker);
+
+    const HeaderView& header() const { return header_; }
+    crypto::PublicKey origin() const { return header_.author(); }
+    Round round() const { return header_.round(); }
+    crypto::Digest digest() const { return header_.digest(); }
+
+    // The signer bitmap, read in place; see Votes.
+    Votes::Mode vote_mode() const { return vote_mode_; }
+    size_t signer_width() const { return signer_width_; }
+    size_t signer_count() const { return signer_count_; }
+    bool signed_by(Votes::Index signer) const {
+        // Bitmap words are little-endian, so bit i sits in byte i / 8.
+        return signer < signer_width_ && (votes_[8 + signer / 8] >> (signer % 8)) & 1;
+    }
+    size_t signature_count() const { return signature_count_; }
+    crypto::Signature signature(size_t i) const;
+
+    Certificate materialize() const;
+
+private:
+    HeaderView header_;
+    // The encoded Votes: width, bitmap words, mode, signatures.
+    std::span<const uint8_t> votes_;
+    Votes::Mode vote_mode_ = Votes::Mode::INDIVIDUAL;
+    size_t signer_width_ = 0;
+    size_t signer_count_ = 0;
+    size_t signature_count_ = 0;
+};
+
+/**
+ * @brief Drops inbound certificates that the DAG would not take.
+ *
+ * accept() runs on the unverified view. It rejects a certificate whose
+ * author is not in the committee, whose round is outside the `window`
+ * rounds from the local floor up, or whose author already has a verified
+ * certificate for that round. The floor only moves with local progress
+ * (advance()), never with what peers send.
+ *
+ * record() marks a certificate once its votes have verified; the first
+ * verified certificate for an author and round keeps the slot, as in the
+ * DAG. A forgery that passes accept() therefore never blocks the genuine
+ * certificate.
+ *
+ * The seen set is a ring of per-round authority bitmaps, so neither call
+ * allocates. Safe to call from several threads.
+ */
+class InboundFilter {
+public:
+    InboundFilter(config::Committee committee, Round window);
+
+    bool accept(const CertificateView& certificate);
+    // Returns false if the certificate is out of the window or its author
+    // already holds the round.
+    bool record(const Certificate& certificate);
+    // Raises the floor to `round`, the lowest round the DAG still takes.
+    void advance(Round round);
+
+private:
+    // Bitmap of verified authors at `round`, or an empty span if the row
+    // still holds an older round.
+    std::span<uint64_t> seen(Round round);
+    bool in_window(Round round) const { return round >= floor_ && round - floor_ <= window_; }
+
+    config::Committee committee_;
+    Round window_;
+    size_t words_;
+
+    std::mutex mutex_;
+    Round floor_ = 0;
+    // Row i holds the authorities verified at rounds_[i], for rounds congruent to i.
+    std::vector<Round> rounds_;
+    std::vector<uint64_t> seen_;
+};
+
+} // namespace narwhal::consensus
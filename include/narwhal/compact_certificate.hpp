@@ -0,0 +1,90 @@
+#pragma once
+
+#include "narwhal/consensus_engines.hpp"
+#include <mutex>
+
+namespace narwhal::consensus {
+
+/**
+ * @brief Which certificate holds each authority slot of the recent rounds.
+ *
+ * The network-side mirror of the DAG index that compact encoding resolves
+ * parents against: the DAG itself belongs to the consensus loop, while
+ * this table is shared by the io threads. The first certificate recorded
+ * for a (round, slot) keeps it, as in the DAG, so only certificates whose
+ * votes have verified (and our own) may be recorded. A ring of `depth`
+ * rounds, so memory is fixed; rounds that fall out of it are forgotten.
+ */
+class SlotTable {
+public:
+    using Index = config::Committee::Index;
+
+    SlotTable(config::Committee committee, Round depth);
+
+    // Records the certificate under its author's slot; returns false if the
+    // author is unknown or the slot is already taken.
+    bool insert(const Certificate& certificate);
+    bool insert(Round round, Index slot, const crypto::Digest& digest);
+
+    std::optional<crypto::Digest> get(Round round, Index slot) const;
+    // The first slot at or after `from` holding `digest` in `round`.
+    std::optional<Index> find(Round round, const crypto::Digest& digest, Index from = 0) const;
+
+    size_t width() const { return committee_.size(); }
+
+private:
+    // Row of `round`, or nullptr if the ring holds a different round there.
+    const crypto::Digest* row(Round round) const;
+
+    config::Committee committee_;
+    mutable std::mutex mutex_;
+    std::vector<Round> rounds_;
+    std::vector<uint64_t> present_;
+    std::vector<crypto::Digest> digests_;
+};
+
+/**
+ * @brief The compact wire form of a certificate.
+ *
+ * Replaces the header's parent digests with a bitmap over the authority
+ * slots of round - 1, plus the digests of any parents the slot table could
+ * not place. Parents are listed in the full encoding as the slot-ordered
+ * prefix followed by the exceptions, so a leading run of parents in
+ * increasing slot order (the usual case) compresses and the rest are sent
+ * whole.
+ *
+ * Layout: author, round, certificate digest, slot width, bitmap words,
+ * exception count and digests, then the payload and votes exactly as in
+ * the full encoding. The receiver expands this back to the full encoding
+ * and checks it against the digest, so a slot resolved to a different
+ * certificate is caught before verification and the full encoding is
+ * requested instead.
+ */
+class CompactCertificate : public utils::Serializable {
+public:
+    CompactCertificate(const Certificate& certificate, const SlotTable& slots);
+
+    // How many parents went into the bitmap.
+    size_t compressed() const { return compressed_; }
+
+    size_t serialized_size() const override;
+    void serialize_into(std::span<uint8_t> out) const override;
+
+private:
+    const Certificate& certificate_;
+    utils::Bitmap parents_;
+    size_t compressed_ = 0;
+};
+
+// Rebuilds the full encoding of a compact certificate into `out`. Returns
+// false, leaving `out` unspecified, if a parent slot is not in `slots` or
+// the rebuilt header does not hash to the digest sent; the caller then asks
+// the sender for the full certificate. Throws std::runtime_error on
+// malformed input.
+bool expand_compact(std::span<const uint8_t> compact, const SlotTable& slots, std::vector<uint8_t>& out);
+
+// The author and round of a compact certificate, read without resolving
+// its parents. Throws std::runtime_error on truncated input.
+std::pair<crypto::PublicKey, Round> compact_origin(std::span<const uint8_t> compact);
+
+} // namespace narwhal::consensus
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "narwhal/crypto.hpp"
+#include "narwhal/flat_hash_map.hpp"
+#include <chrono>
 #include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace narwhal::config {
@@ -15,39 +21,105 @@ struct Authority {
     std::string worker_address;
 };
 
+/**
+ * @brief The set of authorities for an epoch, built once and never modified.
+ *
+ * Authorities are kept in public key order and identified by their dense
+ * index in that order, which is also their slot in every DAG round. Stakes
+ * live in a flat array and the totals and thresholds are computed at
+ * construction, so the vote-counting loops never touch a key.
+ */
 class Committee {
 public:
-    std::map<crypto::PublicKey, Authority> authorities;
+    using Index = uint32_t;
+    using Member = std::pair<crypto::PublicKey, Authority>;
 
     Committee() = default;
 
-    Stake total_stake() const {
-        Stake total = 0;
-        for (const auto& [_, auth] : authorities) {
-            total += auth.stake;
+    explicit Committee(const std::map<crypto::PublicKey, Authority>& authorities) {
+        members_.assign(authorities.begin(), authorities.end());
+        indices_.reserve(members_.size());
+        for (const auto& [name, authority] : members_) {
+            indices_.try_emplace(name, static_cast<Index>(stakes_.size()));
+            stakes_.push_back(authority.stake);
+            total_stake_ += authority.stake;
         }
-        return total;
+        quorum_threshold_ = (total_stake_ * 2) / 3 + 1;
+        validity_threshold_ = total_stake_ == 0 ? 1 : (total_stake_ - 1) / 3 + 1;
     }
 
-    Stake quorum_threshold() const {
-        return (total_stake() * 2) / 3 + 1;
-    }
+    // Members in index order.
+    std::span<const Member> authorities() const { return members_; }
 
-    Stake validity_threshold() const {
-        return (total_stake() - 1) / 3 + 1;
-    }
+    size_t size() const { return members_.size(); }
 
-    size_t size() const {
-        return authorities.size();
+    std::optional<Index> index_of(const crypto::PublicKey& name) const {
+        auto it = indices_.find(name);
+        if (it == indices_.end()) return std::nullopt;
+        return it->second;
     }
 
+    const crypto::PublicKey& key(Index index) const { return members_[index].first; }
+    const Authority& authority(Index index) const { return members_[index].second; }
+    Stake stake(Index index) const { return stakes_[index]; }
+    std::span<const Stake> stakes() const { return stakes_; }
+
+    Stake total_stake() const { return total_stake_; }
+    Stake quorum_threshold() const { return quorum_threshold_; }
+    Stake validity_threshold() const { return validity_threshold_; }
+
     Stake get_stake(const crypto::PublicKey& name) const {
-        auto it = authorities.find(name);
-        if (it != authorities.end()) {
-            return it->second.stake;
+        auto index = index_of(name);
+        return index ? stakes_[*index] : 0;
+    }
+
+private:
+    std::vector<Member> members_;
+    std::vector<Stake> stakes_;
+    utils::FlatHashMap<crypto::PublicKey, Index> indices_;
+    Stake total_stake_ = 0;
+    Stake quorum_threshold_ = 1;
+    Stake validity_threshold_ = 1;
+};
+
+// Where a component's threads run. Empty `cpus` leaves scheduling to the OS;
+// a negative `numa_node` leaves memory placement alone.
+struct Placement {
+    std::vector<int> cpus;
+    int numa_node = -1;
+
+    bool empty() const { return cpus.empty() && numa_node < 0; }
+
+    // Parses "CPUS[@NODE]", where CPUS is a taskset-style list such as "0-3,8".
+    static Placement parse(const std::string& spec) {
+        Placement placement;
+        auto at = spec.find('@');
+        if (at != std::string::npos) placement.numa_node = std::stoi(spec.substr(at + 1));
+        std::string list = spec.substr(0, at);
+        for (size_t begin = 0; begin < list.size();) {
+            size_t end = list.find(',', begin);
+            if (end == std::string::npos) end = list.size();
+            std::string range = list.substr(begin, end - begin);
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            if (first < 0 || last < first) throw std::invalid_argument("invalid cpu range: " + range);
+            for (int cpu = first; cpu <= last; ++cpu) placement.cpus.push_back(cpu);
+            begin = end + 1;
         }
-        return 0;
+        return placement;
     }
 };
 
+struct Parameters {
+    // Most certificates the consensus loop inserts before running the commit rule.
+    size_t max_batch_size = 256;
+    // How long the consensus loop keeps filling a batch after its first certificate.
+    std::chrono::microseconds max_batch_delay{0};
+    // Applied to the thread started by Consensus::spawn().
+    Placement placement;
+    // When set, the consensus loop records its input stream to a replay log here.
+    std::string record_path;
+};
+
 } // namespace narwhal::config
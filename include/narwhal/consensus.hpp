@@ -2,6 +2,10 @@
 
 #include "narwhal/consensus_engines.hpp"
 #include "narwhal/utils.hpp"
+#include "narwhal/executor.hpp"
+#include "narwhal/placement.hpp"
+#include "narwhal/recorder.hpp"
+#include <functional>
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -12,29 +16,63 @@ class Consensus {
 private:
     config::Committee committee;
     Round gc_depth;
+    config::Parameters parameters;
     
-    std::shared_ptr<utils::Channel<Certificate>> rx_primary;
-    std::shared_ptr<utils::Channel<Certificate>> tx_primary;
-    std::shared_ptr<utils::Channel<Certificate>> tx_output;
+    std::shared_ptr<utils::Channel<CertificateRef>> rx_primary;
+    std::shared_ptr<utils::Channel<CertificateRef>> tx_primary;
+    std::shared_ptr<utils::Channel<CertificateRef>> tx_output;
 
     std::atomic<bool> running{false};
     std::thread worker_thread;
     
     std::unique_ptr<ConsensusEngine> engine;
 
+    // Loop state, set up by run() or spawn(executor).
+    std::unique_ptr<State> state;
+    std::vector<CertificateRef> batch;
+    std::vector<Dag::Position> supported;
+    std::vector<Round> rounds;
+    std::function<void(std::vector<CertificateRef>)> retire;
+    std::unique_ptr<Recorder> recorder;
+
+    // Executor mode only. Commits wait here rather than block a worker on
+    // a full channel; the consumer is declared last so it detaches before
+    // the rest goes away.
+    std::unique_ptr<utils::Outbox<CertificateRef>> to_primary;
+    std::unique_ptr<utils::Outbox<CertificateRef>> to_output;
+    std::unique_ptr<utils::Consumer<CertificateRef>> consumer;
+
+    // Fills `batch` from rx_primary within the batching limits; 0 once closed.
+    size_t receive_batch(std::span<CertificateRef> batch);
+    void prepare();
+    // Inserts batch[0, count) and runs the engine over the affected rounds.
+    void process(size_t count);
+    void commit(const std::vector<CertificateRef>& sequence);
+    // Executor mode: sends held back commits. If some still do not fit,
+    // pauses the consumer until the channel that is full frees room.
+    bool flushed();
+
 public:
     Consensus(config::Committee committee, Round gc_depth,
-              std::shared_ptr<utils::Channel<Certificate>> rx,
-              std::shared_ptr<utils::Channel<Certificate>> tx_p,
-              std::shared_ptr<utils::Channel<Certificate>> tx_o,
-              std::unique_ptr<ConsensusEngine> engine = std::make_unique<TuskEngine>());
+              std::shared_ptr<utils::Channel<CertificateRef>> rx,
+              std::shared_ptr<utils::Channel<CertificateRef>> tx_p,
+              std::shared_ptr<utils::Channel<CertificateRef>> tx_o,
+              std::unique_ptr<ConsensusEngine> engine = std::make_unique<TuskEngine>(),
+              config::Parameters parameters = {});
     
     ~Consensus();
 
+    // Runs the loop on a dedicated thread.
     void spawn();
+    // Runs the loop as tasks on a serial lane of `executor`, which must outlive this.
+    void spawn(utils::Executor& executor);
     void run();
+    // Waits for the thread started by spawn() to finish, which it does once
+    // rx_primary is closed and drained. Destroying the Consensus instead
+    // stops the loop without draining.
+    void join();
 
-    static std::vector<Certificate> genesis(const config::Committee& committee);
+    static std::vector<CertificateRef> genesis(const config::Committee& committee);
 };
 
 } // namespace narwhal::consensus
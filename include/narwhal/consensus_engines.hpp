@@ -3,86 +3,391 @@
 #include "narwhal/crypto.hpp"
 #include "narwhal/config.hpp"
 #include "narwhal/serializable.hpp"
+#include "narwhal/bitmap.hpp"
+#include "narwhal/flat_hash_map.hpp"
+#include "narwhal/payload.hpp"
+#include "narwhal/votes.hpp"
 #include <vector>
 #include <map>
-#include <unordered_map>
+#include <deque>
 #include <optional>
+#include <span>
+#include <memory>
+#include <atomic>
 
 namespace narwhal::consensus {
 
 using Round = uint64_t;
 using Stake = config::Stake;
 
+class CertificateView;
+
 struct Header : public utils::Serializable {
-    crypto::PublicKey author;
-    Round round;
+    crypto::PublicKey author{};
+    Round round = 0;
     std::vector<crypto::Digest> parents;
-    std::unordered_map<crypto::Digest, uint32_t> payload;
+    Payload payload;
 
-    std::vector<uint8_t> serialize() const override;
+    size_t serialized_size() const override;
+    void serialize_into(std::span<uint8_t> out) const override;
+    // The payload section alone, which the compact form shares.
+    void serialize_payload_into(utils::Writer& writer) const;
+    // Rejects payloads that are not in canonical order, so a decoded header
+    // re-encodes to the bytes its digest was taken over.
+    static Header deserialize(utils::Unpacker& unpacker);
 };
 
-struct Certificate : public utils::Serializable {
-    Header header;
-    std::vector<std::pair<crypto::PublicKey, crypto::Signature>> votes;
+/**
+ * @brief A header together with the votes certifying it.
+ *
+ * The header is fixed at construction and its digest is computed exactly once
+ * there, so digest() is a plain field read.
+ */
+class Certificate : public utils::Serializable {
+public:
+    Certificate() : Certificate(Header{}) {}
+    explicit Certificate(Header header, Votes votes = {});
+
+    Votes votes;
+
+    const Header& header() const { return header_; }
+    const crypto::Digest& digest() const { return digest_; }
+    const crypto::PublicKey& origin() const { return header_.author; }
+    Round round() const { return header_.round; }
+
+    size_t serialized_size() const override;
+    void serialize_into(std::span<uint8_t> out) const override;
+    // Inverse of serialize(); throws std::runtime_error on malformed input.
+    // The digest is taken over the header bytes as received.
+    static Certificate deserialize(std::span<const uint8_t> data);
+    static Certificate deserialize(utils::Unpacker& unpacker);
+
+private:
+    friend class CertificateView;
 
-    crypto::Digest digest() const;
-    crypto::PublicKey origin() const { return header.author; }
-    Round round() const { return header.round; }
+    Certificate(Header header, Votes votes, const crypto::Digest& digest);
+
+    Header header_;
+    crypto::Digest digest_;
+};
+
+// Certificates are allocated once and shared, immutable, between the channels,
+// the DAG and the engine outputs.
+using CertificateRef = std::shared_ptr<const Certificate>;
+
+// A certificate stored in the DAG; the digest is kept inline so round scans
+// compare digests without touching the certificate.
+struct Vertex {
+    crypto::Digest digest;
+    CertificateRef certificate;
+    size_t slot;
+    // Stake of the next-round vertices that reference this one.
+    Stake support = 0;
+    // Parents referenced by digest that are not in the DAG yet.
+    uint32_t missing_parents = 0;
+};
+
+/**
+ * @brief Round-window DAG with dense authority indexing.
+ *
+ * Rounds live in a ring buffer starting at base(); each round is a flat array
+ * of vertices indexed by authority slot (the position of the authority in the
+ * committee's key order). Garbage collection advances the base instead of
+ * erasing nodes, and scanning a round is a linear sweep over contiguous memory.
+ * The ring doubles if a certificate arrives beyond the current window, but
+ * never past LOOKAHEAD rounds ahead of the last committed round: later
+ * certificates are refused, so a bogus round cannot size the ring.
+ * A digest index resolves parent references without scanning rounds; it is
+ * maintained on insert and pruned as rounds are garbage collected.
+ *
+ * Every vertex also carries a bitmap over the slots of the previous round
+ * marking which of its parents are in the DAG (parents that arrive after
+ * their children are patched in when inserted). Reachability between rounds
+ * is then OR-propagation of these bitmaps rather than digest comparisons.
+ *
+ * Whenever a parent link is resolved the child's stake is added to the
+ * parent's support counter, so commit rules test support in O(1); insert()
+ * reports the vertices whose support has just reached the validity threshold.
+ */
+class Dag {
+public:
+    using Slot = size_t;
+
+    struct Position {
+        Round round;
+        Slot slot;
+    };
+
+    struct InsertResult {
+        bool inserted = false;
+        // Vertices whose support crossed validity_threshold() with this insert.
+        std::vector<Position> supported;
+    };
+
+    // How far past the last committed round a certificate may be.
+    static constexpr Round LOOKAHEAD = 1024;
+
+    Dag(const config::Committee& committee, Round gc_depth);
+
+    // Number of authority slots per round.
+    size_t width() const { return committee_.size(); }
+    // Lowest round still held by the DAG.
+    Round base() const { return base_; }
+    // Highest round any certificate has been inserted at.
+    Round highest_round() const { return highest_round_; }
+
+    std::optional<Slot> slot_of(const crypto::PublicKey& author) const;
+    const crypto::PublicKey& key_of(Slot slot) const { return committee_.key(static_cast<config::Committee::Index>(slot)); }
+    Stake stake_of(Slot slot) const { return committee_.stake(static_cast<config::Committee::Index>(slot)); }
+
+    // Inserts a certificate; fails if its author is unknown, its round was
+    // already garbage collected or is beyond LOOKAHEAD, or its slot is
+    // already taken.
+    InsertResult insert(const CertificateRef& certificate);
+
+    const Vertex* get(Round round, Slot slot) const;
+    const Vertex* get(Round round, const crypto::PublicKey& author) const;
+    const Vertex* get(const crypto::Digest& digest) const;
+    std::optional<Position> locate(const crypto::Digest& digest) const;
+
+    // All slots of a round (empty if the round is outside the window).
+    std::span<const std::optional<Vertex>> round(Round round) const;
+
+    // Bitmap of the parents of (round, slot) over the slots of round - 1.
+    std::span<const uint64_t> parents(Round round, Slot slot) const;
+
+    // Slots of `target` reachable from `from` by following parent links.
+    utils::Bitmap reachable(Position from, Round target) const;
+    // Whether `to` is in the causal history of `from`.
+    bool linked(Position from, Position to) const;
+
+    // Drops every round below new_base, appending the released certificates
+    // to `released`.
+    void advance(Round new_base, std::vector<CertificateRef>& released);
+
+private:
+    size_t row(Round round) const { return (round & (capacity_ - 1)) * width(); }
+    std::span<uint64_t> parent_bits(Round round, Slot slot) {
+        return {parent_bits_.data() + (row(round) + slot) * words_, words_};
+    }
+    bool in_window(Round round) const { return round >= base_ && round - base_ < capacity_; }
+    void grow(Round round);
+    void link(Position child, Slot parent, InsertResult& result);
 
-    std::vector<uint8_t> serialize() const override;
+    // Slots are committee indices.
+    config::Committee committee_;
+    Round base_ = 0;
+    Round highest_round_ = 0;
+    // Furthest round past base_ that insert() accepts.
+    Round limit_;
+    size_t capacity_;
+    size_t words_;
+    std::vector<std::optional<Vertex>> vertices_;
+    std::vector<uint64_t> parent_bits_;
+    utils::FlatHashMap<crypto::Digest, Position> index_;
+    // Children waiting for a parent that has not been inserted yet.
+    utils::FlatHashMap<crypto::Digest, std::vector<Position>> pending_;
 };
 
-using dag_t = std::map<Round, std::unordered_map<crypto::PublicKey, std::pair<crypto::Digest, Certificate>>>;
+/**
+ * Round -> leader slot assignment, built once per committee or reputation
+ * epoch. Leaders rotate through `order` with `leaders_per_round` consecutive
+ * entries per round, so a lookup is a single index computation.
+ */
+class LeaderSchedule {
+public:
+    // Round-robin over every authority slot in committee key order.
+    explicit LeaderSchedule(const config::Committee& committee, size_t leaders_per_round = 1);
+    // Rotation over `order`, in force from round `start` on.
+    LeaderSchedule(std::vector<Dag::Slot> order, size_t leaders_per_round, Round start = 0);
+
+    Dag::Slot leader(Round round, size_t index = 0) const { return order_[(round * per_round_ + index) % order_.size()]; }
+    size_t leaders_per_round() const { return per_round_; }
+    Round start() const { return start_; }
+    std::span<const Dag::Slot> order() const { return order_; }
+
+private:
+    std::vector<Dag::Slot> order_;
+    size_t per_round_;
+    Round start_;
+};
 
 struct State {
     Round last_committed_round;
-    std::unordered_map<crypto::PublicKey, Round> last_committed;
-    dag_t dag;
+    // Highest committed round per authority slot.
+    std::vector<Round> last_committed;
+    Round gc_depth;
+    Dag dag;
+
+    State(const config::Committee& committee, Round gc_depth, const std::vector<CertificateRef>& genesis);
 
-    State(const std::vector<Certificate>& genesis);
-    void update(const Certificate& certificate, Round gc_depth);
+    // Applies a whole committed sequence, then garbage collects once. Returns
+    // the certificates released by GC so the caller can drop them off the
+    // critical path.
+    std::vector<CertificateRef> update(std::span<const CertificateRef> sequence);
+};
+
+/**
+ * @brief Orders the causal sub-DAGs of a batch of committed leaders.
+ *
+ * Leaders are fed in commit order. Each call appends the part of the leader's
+ * causal history that is neither already committed nor emitted for an earlier
+ * leader of the batch, in (round, slot) order. Certificates at or below their
+ * author's last committed round count as committed (the reference
+ * implementation purges them from the DAG). That round advances as each
+ * leader's sub-DAG is emitted, so a batch of leaders orders exactly as the
+ * same leaders committed one call at a time. Visited vertices are tracked in a
+ * (round, slot) grid, so a batch costs O(vertices + parent links).
+ */
+class Linearizer {
+public:
+    explicit Linearizer(const State& state);
+
+    void order(const Vertex& leader, std::vector<CertificateRef>& sequence);
+
+private:
+    static constexpr uint32_t SKIPPED = UINT32_MAX;
+
+    uint32_t& mark(Round round, Dag::Slot slot) { return marks[(round - state.dag.base()) * state.dag.width() + slot]; }
+
+    const State& state;
+    // 0 = unseen, SKIPPED = already committed, otherwise 1 + index of the
+    // leader whose sub-DAG emitted the vertex.
+    std::vector<uint32_t> marks;
+    uint32_t leaders = 0;
+    // state.last_committed, advanced over the leaders ordered so far.
+    std::vector<Round> committed;
+};
+
+// Commit status of a leader (anchor) slot, shared by the multi-leader engines.
+enum class Decision { Undecided, Commit, Skip };
+
+struct LeaderSlot {
+    Round round;
+    Dag::Slot slot;
+    Decision decision = Decision::Undecided;
 };
 
 // Abstract Consensus Engine
 class ConsensusEngine {
 public:
     virtual ~ConsensusEngine() = default;
-    virtual std::vector<Certificate> process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) = 0;
+    virtual std::vector<CertificateRef> process_round(Round round, Dag& dag, State& state, const config::Committee& committee) = 0;
+
+    // Called the moment a vertex's support reaches the validity threshold, so
+    // engines can run their commit rule without waiting for a later round.
+    virtual std::vector<CertificateRef> on_supported(const Vertex&, Dag&, State&, const config::Committee&) { return {}; }
+
+    // The leader schedule in force; safe to read from any thread.
+    std::shared_ptr<const LeaderSchedule> leader_schedule() const { return schedule_.load(std::memory_order_acquire); }
+
+protected:
+    // Returns the schedule in force, installing a round-robin one on first use.
+    std::shared_ptr<const LeaderSchedule> schedule_for(const config::Committee& committee, size_t leaders_per_round = 1);
+    void publish(std::shared_ptr<const LeaderSchedule> schedule) { schedule_.store(std::move(schedule), std::memory_order_release); }
+
+private:
+    std::atomic<std::shared_ptr<const LeaderSchedule>> schedule_;
 };
 
+// Engine by name ("tusk", "shoal++", "mysticeti"); nullptr if unknown.
+std::unique_ptr<ConsensusEngine> make_engine(const std::string& name);
+
 // Tusk Implementation (Classic)
 class TuskEngine : public ConsensusEngine {
 public:
-    std::vector<Certificate> process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) override;
+    std::vector<CertificateRef> process_round(Round round, Dag& dag, State& state, const config::Committee& committee) override;
+    std::vector<CertificateRef> on_supported(const Vertex& vertex, Dag& dag, State& state, const config::Committee& committee) override;
 
 private:
-    std::optional<std::pair<crypto::Digest, Certificate>> leader(Round round, const dag_t& dag, const config::Committee& committee);
-    std::vector<Certificate> order_leaders(const Certificate& leader, const State& state, const dag_t& dag, const config::Committee& committee);
-    bool linked(const Certificate& leader, const Certificate& prev_leader, const dag_t& dag);
-    std::vector<Certificate> order_dag(const Certificate& leader, const State& state);
+    std::vector<CertificateRef> commit(const Vertex& leader, Dag& dag, State& state, const config::Committee& committee);
+    const Vertex* leader(Round round, const Dag& dag, const LeaderSchedule& schedule) const;
+    std::vector<const Vertex*> order_leaders(const Vertex& leader, const State& state, const Dag& dag, const LeaderSchedule& schedule) const;
 };
 
 // Shoal++ Implementation (High Performance)
+/**
+ * Shoal++ anchoring on the certified DAG: every round carries several anchor
+ * candidates, drawn from the authorities with the best reputation.
+ *
+ * Fast direct rule: commit an anchor as soon as f+1 stake at the next round
+ * references it; skip it once a quorum there does not, as no f+1 can then
+ * reference it. Indirect rule: an undecided anchor at round r is decided by
+ * the first later anchor at round >= r+2 that is not skipped: commit if it is
+ * in that anchor's causal history, skip if not. Without the direct skip an
+ * absent anchor waits on the next one, and a schedule that places the same
+ * absent authority every other round never decides again.
+ *
+ * Reputation is the number of certificates each authority has in the last
+ * `reputation_window` committed sub-DAGs. A new LeaderSchedule is published
+ * after each committed anchor and applies from the next round on, so every
+ * node derives the same schedule from the same committed sequence.
+ */
 class ShoalPlusPlusEngine : public ConsensusEngine {
 public:
-    std::vector<Certificate> process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) override;
+    explicit ShoalPlusPlusEngine(size_t anchors_per_round = 2, size_t reputation_window = 16);
+
+    std::vector<CertificateRef> process_round(Round round, Dag& dag, State& state, const config::Committee& committee) override;
 
 private:
-    // Leader reputation based on past performance
-    std::unordered_map<crypto::PublicKey, uint64_t> reputation;
-    void update_reputation(const std::vector<Certificate>& committed);
-    std::optional<std::pair<crypto::Digest, Certificate>> select_anchor(Round round, const dag_t& dag, const config::Committee& committee);
+    const LeaderSchedule& schedule_at(Round round) const { return round < schedule->start() ? *previous : *schedule; }
+    // Appends the candidates from (round, index) up to but excluding `end`.
+    void add_candidates(std::vector<LeaderSlot>& anchors, Round round, size_t index, Round end) const;
+    // Decides anchors[i], first deciding the later candidates it depends on.
+    // Each candidate is decided at most once until its `settled` flag is
+    // cleared, so a run costs time linear in the candidates it reaches.
+    Decision decide(std::vector<LeaderSlot>& anchors, std::vector<bool>& settled, size_t i,
+                    const Dag& dag, const config::Committee& committee) const;
+    void update_reputation(std::span<const CertificateRef> committed, const Dag& dag);
+    void reschedule(Round from);
+
+    size_t anchors_per_round;
+    size_t reputation_window;
+    // The published schedule, and the one it replaced for rounds before its start.
+    std::shared_ptr<const LeaderSchedule> schedule;
+    std::shared_ptr<const LeaderSchedule> previous;
+    // Certificates per slot over the window, and the slots of each committed sub-DAG in it.
+    std::vector<uint64_t> reputation;
+    std::deque<std::vector<Dag::Slot>> window;
+    // First anchor candidate not yet decided.
+    Round next_round = 1;
+    size_t next_index = 0;
 };
 
 // Mysticeti Implementation (Next-Gen)
+/**
+ * Mysticeti-C commit pipeline on the certificate DAG, with several leader
+ * slots per round and a wave length of 3. A vertex at r+1 referencing leader L
+ * (round r) votes for L; a vertex at r+2 whose parents hold a quorum of votes
+ * certifies L.
+ *
+ * Direct rule: commit L once a quorum of r+2 vertices certify it; skip L once
+ * a quorum of r+1 vertices (with all their parents known) do not vote for it.
+ * Indirect rule: otherwise L is decided by its anchor, the first leader at
+ * round >= r+3 that is not skipped: commit if a certificate for L is in the
+ * anchor's causal history, skip if not, and stay undecided while the anchor is.
+ *
+ * Leaders are emitted in (round, slot index) order up to the first undecided
+ * one, each followed by its causal sub-DAG.
+ */
 class MysticetiEngine : public ConsensusEngine {
 public:
-    std::vector<Certificate> process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) override;
+    explicit MysticetiEngine(size_t leaders_per_round = 2);
+
+    std::vector<CertificateRef> process_round(Round round, Dag& dag, State& state, const config::Committee& committee) override;
 
 private:
-    std::optional<crypto::PublicKey> get_leader(Round round, const config::Committee& committee);
-    bool can_commit(Round round, const dag_t& dag, const config::Committee& committee);
+    static constexpr Round wave_length = 3;
+
+    Decision decide_direct(const LeaderSlot& leader, const Dag& dag, const config::Committee& committee) const;
+    Decision decide_from_anchor(const LeaderSlot& leader, const LeaderSlot& anchor, const Dag& dag, const config::Committee& committee) const;
+    // Slots of round + 2 whose vertices certify the leader at (round, slot).
+    utils::Bitmap certifiers(const LeaderSlot& leader, const Dag& dag, const config::Committee& committee) const;
+
+    size_t leaders_per_round;
+    // First leader slot not yet decided.
+    Round next_round = 1;
+    size_t next_index = 0;
 };
 
 } // namespace narwhal::consensus
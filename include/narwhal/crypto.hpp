@@ -1,6 +1,9 @@
 #pragma once
 
 #include <array>
+#include <bit>
+#include <cstring>
+#include <span>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -25,22 +28,69 @@ public:
 };
 
 struct Hash {
-    static Digest compute(const std::vector<uint8_t>& data);
+    static Digest compute(std::span<const uint8_t> data);
     static std::string to_hex(const Digest& digest);
 };
 
+/**
+ * @brief A signature scheme whose signatures over one message combine.
+ *
+ * aggregate() folds the signatures of several signers into one, which
+ * verify() checks against all of their public keys at once. A certificate
+ * in aggregate mode carries only that one signature.
+ */
+class AggregateScheme {
+public:
+    virtual ~AggregateScheme() = default;
+    virtual Signature aggregate(std::span<const Signature> signatures) const = 0;
+    virtual bool verify(std::span<const uint8_t> message, const Signature& aggregate,
+                        std::span<const PublicKey> signers) const = 0;
+};
+
+/**
+ * @brief Reference AggregateScheme for tests and offline runs.
+ *
+ * A signature is a hash of the signer's public key and the message, and
+ * aggregation XORs them. Anyone can compute any signer's signature, so this
+ * proves nothing about who signed; it exists to exercise the aggregate
+ * encoding and verification path without a pairing library.
+ */
+class InsecureAggregate : public AggregateScheme {
+public:
+    static Signature sign(std::span<const uint8_t> message, const PublicKey& signer);
+
+    Signature aggregate(std::span<const Signature> signatures) const override;
+    bool verify(std::span<const uint8_t> message, const Signature& aggregate,
+                std::span<const PublicKey> signers) const override;
+};
+
 } // namespace narwhal::crypto
 
-// Hash specialization for std::array (needed for unordered_map)
+// Hash specialization for std::array (needed for unordered_map). Keys are
+// consumed a 64-bit word at a time and finished with the murmur3 mixer, so
+// keys differing in any byte spread over the whole range.
 namespace std {
     template<size_t N>
     struct hash<std::array<uint8_t, N>> {
-        size_t operator()(const std::array<uint8_t, N>& a) const {
-            size_t h = 0;
-            for (auto x : a) {
-                h ^= std::hash<uint8_t>{}(x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        size_t operator()(const std::array<uint8_t, N>& a) const noexcept {
+            uint64_t h = N;
+            size_t i = 0;
+            for (; i + 8 <= N; i += 8) {
+                uint64_t word;
+                std::memcpy(&word, a.data() + i, sizeof(word));
+                h = std::rotl(h ^ (word * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+            }
+            if (i < N) {
+                uint64_t word = 0;
+                std::memcpy(&word, a.data() + i, N - i);
+                h = std::rotl(h ^ (word * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
             }
-            return h;
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
         }
     };
 }
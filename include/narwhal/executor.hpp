@@ -0,0 +1,295 @@
+#pragma once
+
+#include "narwhal/utils.hpp"
+#include "narwhal/placement.hpp"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace narwhal::utils {
+
+/**
+ * @brief Process-wide work-stealing task pool.
+ *
+ * Every worker owns a deque. Tasks posted from a worker go to the back of
+ * its own deque and are popped from the back (most recent first, while
+ * their data is still in cache). Tasks posted from other threads go to a
+ * shared injection queue. An idle worker takes from the injection queue,
+ * then steals from the front of the other workers' deques, and parks once
+ * there is nothing left anywhere.
+ *
+ * The destructor runs every task already queued, including tasks those
+ * tasks post, before joining the workers.
+ *
+ * Every worker applies `placement` when it starts. It is best effort:
+ * check it with placement_available() beforehand.
+ */
+class Executor {
+public:
+    using Task = std::function<void()>;
+
+    explicit Executor(size_t threads = std::max(1u, std::thread::hardware_concurrency()),
+                      config::Placement placement = {})
+        : placement(std::move(placement)) {
+        for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) queues.push_back(std::make_unique<Queue>());
+        for (size_t i = 0; i < queues.size(); ++i) workers.emplace_back(&Executor::run, this, i);
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    ~Executor() {
+        stopping.store(true);
+        wake(true);
+        for (auto& worker : workers) worker.join();
+    }
+
+    void post(Task task) {
+        Queue& queue = current == this ? *queues[current_index] : injection;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1);
+        wake(false);
+    }
+
+    size_t size() const { return workers.size(); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    static constexpr int SPIN_LIMIT = 64;
+
+    void run(size_t index) {
+        place_current_thread(placement);
+        current = this;
+        current_index = index;
+        Task task;
+        for (;;) {
+            if (next(index, task)) {
+                queued.fetch_sub(1);
+                task();
+                task = nullptr;
+                continue;
+            }
+            if (!park()) return;
+        }
+    }
+
+    bool next(size_t index, Task& task) {
+        if (pop_back(*queues[index], task) || pop_front(injection, task)) return true;
+        for (size_t i = 1; i < queues.size(); ++i) {
+            if (pop_front(*queues[(index + i) % queues.size()], task)) return true;
+        }
+        return false;
+    }
+
+    static bool pop_back(Queue& queue, Task& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static bool pop_front(Queue& queue, Task& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    // Waits for work; returns false once stopping with nothing left to run.
+    bool park() {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (queued.load() != 0) return true;
+            if (i >= SPIN_LIMIT / 2) std::this_thread::yield();
+        }
+        for (;;) {
+            uint32_t seen = epoch.load();
+            sleepers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool ready = queued.load() != 0;
+            bool done = !ready && stopping.load();
+            if (ready || done) {
+                sleepers.fetch_sub(1);
+                return ready;
+            }
+            epoch.wait(seen);
+            sleepers.fetch_sub(1);
+        }
+    }
+
+    void wake(bool all) {
+        epoch.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load() == 0) return;
+        if (all) epoch.notify_all();
+        else epoch.notify_one();
+    }
+
+    inline static thread_local Executor* current = nullptr;
+    inline static thread_local size_t current_index = 0;
+
+    config::Placement placement;
+    std::vector<std::unique_ptr<Queue>> queues;
+    Queue injection;
+    std::atomic<size_t> queued{0};
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint32_t> sleepers{0};
+    std::atomic<bool> stopping{false};
+    std::vector<std::thread> workers;
+};
+
+/**
+ * @brief A serial lane on an Executor.
+ *
+ * Tasks posted to a strand run one at a time, in order, on whichever worker
+ * picks the strand up. After a bounded number of tasks the strand yields its
+ * worker so other work is not starved.
+ */
+class Strand : public std::enable_shared_from_this<Strand> {
+public:
+    using Task = Executor::Task;
+
+    explicit Strand(Executor& executor) : executor(executor) {}
+
+    void post(Task task) {
+        bool schedule;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+            schedule = !active;
+            active = true;
+        }
+        if (schedule) executor.post([self = shared_from_this()] { self->run(); });
+    }
+
+private:
+    static constexpr int BATCH = 64;
+
+    void run() {
+        for (int i = 0; i < BATCH; ++i) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty()) {
+                    active = false;
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+        executor.post([self = shared_from_this()] { self->run(); });
+    }
+
+    Executor& executor;
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    bool active = false;
+};
+
+/**
+ * @brief Drains a channel on a strand whenever it has data.
+ *
+ * Instead of parking a thread in receive(), the consumer registers itself as
+ * the channel's listener and schedules `drain` on the strand when something
+ * is sent (or the channel closes). `drain` should take everything available
+ * with try_receive_batch(). Destroying the consumer detaches it and waits for
+ * a drain in flight, so it must be declared after everything `drain` uses.
+ *
+ * A `drain` whose own output is full should pause() and return rather than
+ * wait for room on the executor; nothing is drained until resume(). A
+ * consumer constructed paused lets its owner finish setting up what
+ * `drain` uses before the first drain runs.
+ */
+template<typename T>
+class Consumer {
+public:
+    Consumer(std::shared_ptr<Strand> strand, std::shared_ptr<Channel<T>> channel, std::function<void()> drain,
+             bool paused = false)
+        : control(std::make_shared<Control>()) {
+        control->strand = std::move(strand);
+        control->channel = std::move(channel);
+        control->drain = std::move(drain);
+        control->paused.store(paused);
+        control->listener = [c = control.get()] { c->schedule(); };
+        control->channel->set_listener(&control->listener);
+        // Anything sent before the listener was installed.
+        control->schedule();
+    }
+
+    void pause() { control->paused.store(true); }
+
+    // Schedules a drain even if nothing new was sent.
+    void resume() {
+        control->paused.store(false);
+        control->resumed.store(true);
+        control->schedule();
+    }
+
+    Consumer(const Consumer&) = delete;
+    Consumer& operator=(const Consumer&) = delete;
+
+    ~Consumer() {
+        control->channel->set_listener(nullptr);
+        {
+            std::lock_guard<std::mutex> lock(control->mutex);
+            control->closing.store(true);
+        }
+        while (control->scheduled.load()) control->scheduled.wait(true);
+    }
+
+private:
+    struct Control : std::enable_shared_from_this<Control> {
+        std::shared_ptr<Strand> strand;
+        std::shared_ptr<Channel<T>> channel;
+        std::function<void()> drain;
+        std::function<void()> listener;
+        std::atomic<bool> scheduled{false};
+        std::atomic<bool> paused{false};
+        // A resume() that may have found a drain in flight.
+        std::atomic<bool> resumed{false};
+        std::mutex mutex;
+        std::atomic<bool> closing{false};
+        // Set once drain() has run after the channel closed, so it gets to
+        // observe the close exactly once more.
+        bool closed_seen = false;
+
+        void schedule() {
+            if (!scheduled.exchange(true)) strand->post([self = this->shared_from_this()] { self->run(); });
+        }
+
+        void run() {
+            for (;;) {
+                if (!closing.load() && !paused.load()) {
+                    resumed.store(false);
+                    bool closed = channel->is_closed();
+                    drain();
+                    closed_seen = closed_seen || closed;
+                }
+                scheduled.store(false);
+                scheduled.notify_all();
+
+                // A send, close or resume() that raced with the end of drain()
+                // found the flag still set and did not schedule; pick it up here.
+                std::lock_guard<std::mutex> lock(mutex);
+                bool idle = paused.load() ||
+                            (!resumed.load() && channel->empty() && (closed_seen || !channel->is_closed()));
+                if (closing.load() || idle || scheduled.exchange(true)) return;
+            }
+        }
+    };
+
+    std::shared_ptr<Control> control;
+};
+
+} // namespace narwhal::utils
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace narwhal::utils {
+
+/**
+ * @brief Open-addressing hash map with inline storage.
+ *
+ * Entries live in one flat array probed linearly, beside a byte array of
+ * control tags (empty, erased, or seven bits of the hash), so a lookup
+ * compares keys only on a tag match and rarely leaves a cache line or two.
+ * Erase leaves a tombstone, which keeps iterators valid when erasing during
+ * a traversal; tombstones are dropped on the next rehash.
+ *
+ * K and V must be default constructible, since free slots hold default
+ * values. Inserting may invalidate iterators and references.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>>
+class FlatHashMap {
+public:
+    using value_type = std::pair<K, V>;
+
+    template<bool Const>
+    class Iterator {
+    public:
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = FlatHashMap::value_type;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+        Iterator(Map* map, size_t index) : map(map), index(index) { skip(); }
+        operator Iterator<true>() const requires(!Const) { return {map, index}; }
+
+        reference operator*() const { return map->slots_[index]; }
+        pointer operator->() const { return &map->slots_[index]; }
+        Iterator& operator++() {
+            ++index;
+            skip();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+
+    private:
+        friend class FlatHashMap;
+        void skip() {
+            while (index < map->ctrl_.size() && map->ctrl_[index] < FULL) ++index;
+        }
+
+        Map* map;
+        size_t index;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, ctrl_.size()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, ctrl_.size()}; }
+
+    iterator find(const K& key) { return {this, locate(key)}; }
+    const_iterator find(const K& key) const { return {this, locate(key)}; }
+    bool contains(const K& key) const { return locate(key) != ctrl_.size(); }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        size_t index = locate(key);
+        if (index != ctrl_.size()) return {iterator(this, index), false};
+        reserve(size_ + 1);
+        index = claim(key);
+        slots_[index].first = key;
+        slots_[index].second = V(std::forward<Args>(args)...);
+        return {iterator(this, index), true};
+    }
+
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    // Returns the iterator following `position`.
+    iterator erase(const_iterator position) {
+        size_t index = position.index;
+        ctrl_[index] = ERASED;
+        slots_[index] = value_type{};
+        --size_;
+        ++erased_;
+        return {this, index + 1};
+    }
+
+    size_t erase(const K& key) {
+        size_t index = locate(key);
+        if (index == ctrl_.size()) return 0;
+        erase(const_iterator(this, index));
+        return 1;
+    }
+
+    void clear() {
+        std::fill(ctrl_.begin(), ctrl_.end(), EMPTY);
+        std::fill(slots_.begin(), slots_.end(), value_type{});
+        size_ = 0;
+        erased_ = 0;
+    }
+
+    // Makes room for `count` entries without another rehash.
+    void reserve(size_t count) {
+        if (fits(count + erased_, ctrl_.size())) return;
+        size_t capacity = MIN_CAPACITY;
+        while (!fits(count, capacity)) capacity <<= 1;
+        rehash(capacity);
+    }
+
+private:
+    static constexpr uint8_t EMPTY = 0;
+    static constexpr uint8_t ERASED = 1;
+    static constexpr uint8_t FULL = 0x80;
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    // Linear probing degrades quickly past this load factor.
+    static bool fits(size_t count, size_t capacity) { return count * 4 <= capacity * 3; }
+
+    // Fibonacci hashing: the top bits of the product pick the home slot, the
+    // seven bits below them make the tag.
+    uint64_t mix(const K& key) const { return static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL; }
+    size_t home(uint64_t h) const { return static_cast<size_t>(h >> shift_); }
+    uint8_t tag(uint64_t h) const { return FULL | static_cast<uint8_t>((h >> (shift_ - 7)) & 0x7F); }
+
+    size_t locate(const K& key) const {
+        if (size_ == 0) return ctrl_.size();
+        const uint64_t h = mix(key);
+        const uint8_t t = tag(h);
+        const size_t mask = ctrl_.size() - 1;
+        for (size_t index = home(h);; index = (index + 1) & mask) {
+            if (ctrl_[index] == EMPTY) return ctrl_.size();
+            if (ctrl_[index] == t && slots_[index].first == key) return index;
+        }
+    }
+
+    // Takes the first free slot on the key's probe sequence.
+    size_t claim(const K& key) {
+        const uint64_t h = mix(key);
+        const size_t mask = ctrl_.size() - 1;
+        size_t index = home(h);
+        while (ctrl_[index] >= FULL) index = (index + 1) & mask;
+        if (ctrl_[index] == ERASED) --erased_;
+        ctrl_[index] = tag(h);
+        ++size_;
+        return index;
+    }
+
+    void rehash(size_t capacity) {
+        auto ctrl = std::exchange(ctrl_, std::vector<uint8_t>(capacity, EMPTY));
+        auto slots = std::exchange(slots_, std::vector<value_type>(capacity));
+        shift_ = 64 - std::countr_zero(capacity);
+        size_ = 0;
+        erased_ = 0;
+        for (size_t i = 0; i < ctrl.size(); ++i) {
+            if (ctrl[i] < FULL) continue;
+            slots_[claim(slots[i].first)] = std::move(slots[i]);
+        }
+    }
+
+    [[no_unique_address]] Hash hash_;
+    std::vector<uint8_t> ctrl_;
+    std::vector<value_type> slots_;
+    size_t size_ = 0;
+    size_t erased_ = 0;
+    int shift_ = 64;
+};
+
+} // namespace narwhal::utils
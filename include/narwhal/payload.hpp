@@ -0,0 +1,102 @@
+#pragma once
+
+#include "narwhal/crypto.hpp"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace narwhal::consensus {
+
+using WorkerId = uint32_t;
+
+/**
+ * @brief The batch digests a header carries, with the worker holding each.
+ *
+ * Entries live in one contiguous array sorted by digest with no repeats, so
+ * equal payloads encode to equal bytes whatever order they were built in,
+ * membership is a binary search, and encoding is a linear walk over the
+ * array instead of a chase through hash-table nodes.
+ */
+class Payload {
+public:
+    struct Entry {
+        crypto::Digest digest;
+        WorkerId worker;
+
+        bool operator==(const Entry&) const = default;
+    };
+
+    Payload() = default;
+
+    // Sorts the entries; a digest listed twice keeps its first worker.
+    explicit Payload(std::vector<Entry> entries) : entries_(std::move(entries)) {
+        std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+            return less(a.digest, b.digest);
+        });
+        entries_.erase(std::unique(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+            return a.digest == b.digest;
+        }), entries_.end());
+    }
+
+    Payload(std::initializer_list<Entry> entries) : Payload(std::vector<Entry>(entries)) {}
+
+    // Takes entries that are already strictly ascending by digest, as
+    // checked by is_canonical(); no sort.
+    static Payload from_sorted(std::vector<Entry> entries) {
+        Payload payload;
+        payload.entries_ = std::move(entries);
+        return payload;
+    }
+
+    static bool is_canonical(std::span<const Entry> entries) {
+        for (size_t i = 1; i < entries.size(); ++i) {
+            if (!less(entries[i - 1].digest, entries[i].digest)) return false;
+        }
+        return true;
+    }
+
+    // Adds an entry in place; returns false if the digest is already present.
+    bool insert(const crypto::Digest& digest, WorkerId worker) {
+        auto it = lower_bound(digest);
+        if (it != entries_.end() && it->digest == digest) return false;
+        entries_.insert(it, Entry{digest, worker});
+        return true;
+    }
+
+    bool contains(const crypto::Digest& digest) const { return worker_of(digest).has_value(); }
+
+    std::optional<WorkerId> worker_of(const crypto::Digest& digest) const {
+        auto it = lower_bound(digest);
+        if (it == entries_.end() || it->digest != digest) return std::nullopt;
+        return it->worker;
+    }
+
+    std::span<const Entry> entries() const { return entries_; }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    auto begin() const { return entries_.begin(); }
+    auto end() const { return entries_.end(); }
+
+    void reserve(size_t n) { entries_.reserve(n); }
+
+    bool operator==(const Payload&) const = default;
+
+    // Digest order: memcmp on the raw bytes.
+    static bool less(const crypto::Digest& a, const crypto::Digest& b) {
+        return std::memcmp(a.data(), b.data(), a.size()) < 0;
+    }
+
+private:
+    std::vector<Entry>::const_iterator lower_bound(const crypto::Digest& digest) const {
+        return std::lower_bound(entries_.begin(), entries_.end(), digest, [](const Entry& entry, const crypto::Digest& d) {
+            return less(entry.digest, d);
+        });
+    }
+
+    std::vector<Entry> entries_;
+};
+
+} // namespace narwhal::consensus
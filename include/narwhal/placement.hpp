@@ -0,0 +1,73 @@
+#pragma once
+
+#include "narwhal/config.hpp"
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <filesystem>
+#endif
+
+namespace narwhal::utils {
+
+/**
+ * @brief Whether a placement can be honoured on this machine.
+ *
+ * Every cpu must be in the process's allowed set and the NUMA node must
+ * exist. Meant for validating configuration at startup, since the threads
+ * that apply a placement have nobody to report a failure to.
+ */
+inline bool placement_available(const config::Placement& placement) {
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (!placement.cpus.empty() && sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+    for (int cpu : placement.cpus) {
+        if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)) return false;
+    }
+    return placement.numa_node < 0 ||
+           std::filesystem::exists("/sys/devices/system/node/node" + std::to_string(placement.numa_node));
+#else
+    return placement.empty();
+#endif
+}
+
+/**
+ * @brief Applies a placement to the calling thread.
+ *
+ * Restricts the thread to `cpus` with sched_setaffinity and makes
+ * `numa_node` the preferred node for the pages it allocates from then on,
+ * so the state a component builds on its own thread (the DAG, batch
+ * buffers) is local to the cores it runs on. The node is preferred rather
+ * than bound: when it is full the kernel falls back instead of failing the
+ * allocation. Returns false if the kernel rejected either request; the
+ * thread keeps running either way.
+ */
+inline bool place_current_thread(const config::Placement& placement) {
+#ifdef __linux__
+    bool placed = true;
+    if (!placement.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : placement.cpus) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        placed = sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+    if (placement.numa_node >= 0) {
+        // Called directly rather than through libnuma, which would be a new dependency.
+        constexpr int MPOL_PREFERRED = 1;
+        constexpr unsigned long BITS = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> nodes(placement.numa_node / BITS + 1, 0);
+        nodes[placement.numa_node / BITS] |= 1UL << (placement.numa_node % BITS);
+        placed = syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodes.data(), nodes.size() * BITS + 1) == 0 && placed;
+    }
+    return placed;
+#else
+    return placement.empty();
+#endif
+}
+
+} // namespace narwhal::utils
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "narwhal/consensus_engines.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace narwhal::consensus {
+
+/**
+ * @brief Binary log of a consensus input stream.
+ *
+ * Layout, all integers in Packer's little-endian u64 encoding:
+ *
+ *   "NRPL" version
+ *   committee size, then per authority: public key, stake
+ *   per certificate: nanoseconds since the first record, length, bytes
+ *
+ * The committee is stored so a log can be replayed on its own. A truncated
+ * final record (the node was killed mid-write) is ignored when loading.
+ *
+ * Times are when the consensus loop took each certificate off its input
+ * channel, not when it was enqueued: time spent queued ahead of consensus
+ * is not in the log, so latencies measured by a paced replay leave out
+ * that queueing delay.
+ */
+namespace replay_log {
+inline constexpr std::array<uint8_t, 4> MAGIC = {'N', 'R', 'P', 'L'};
+// Version 2: certificate votes are a signer bitmap (see Votes).
+inline constexpr uint64_t VERSION = 2;
+} // namespace replay_log
+
+// Appends certificates to a replay log. record() is called by the consensus
+// loop only; encoding, writing and flushing happen on a writer thread of the
+// recorder's own, which flushes at least once a second even when no
+// certificates arrive.
+class Recorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Throws std::runtime_error if the file cannot be created.
+    Recorder(const std::string& path, const config::Committee& committee);
+    // Writes out and flushes everything recorded so far.
+    ~Recorder();
+
+    void record(CertificateRef certificate, Clock::time_point arrival);
+
+private:
+    struct Pending {
+        std::chrono::nanoseconds offset;
+        CertificateRef certificate;
+    };
+
+    void write();
+
+    std::ofstream file;
+    std::optional<Clock::time_point> first;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Pending> pending;
+    bool closing = false;
+    std::thread writer;
+};
+
+struct ReplayLog {
+    struct Entry {
+        std::chrono::nanoseconds offset;
+        CertificateRef certificate;
+    };
+
+    config::Committee committee;
+    std::vector<Entry> entries;
+
+    // Throws std::runtime_error if the file is missing or malformed.
+    static ReplayLog load(const std::string& path);
+};
+
+} // namespace narwhal::consensus
@@ -1,22 +1,62 @@
 #pragma once
 
+#include <array>
+#include <bit>
 #include <vector>
 #include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
 
 namespace narwhal::utils {
 
+/**
+ * @brief Something with a fixed binary encoding.
+ *
+ * Implementations report their exact encoded size up front, so callers can
+ * serialize into a buffer they already own (a pooled send buffer, a slot in
+ * a log record) instead of growing a fresh vector.
+ */
 class Serializable {
 public:
     virtual ~Serializable() = default;
-    virtual std::vector<uint8_t> serialize() const = 0;
+
+    virtual size_t serialized_size() const = 0;
+    // Writes exactly serialized_size() bytes to the front of `out`; throws
+    // std::runtime_error if `out` is too small.
+    virtual void serialize_into(std::span<uint8_t> out) const = 0;
+
+    std::vector<uint8_t> serialize() const {
+        std::vector<uint8_t> buf(serialized_size());
+        serialize_into(buf);
+        return buf;
+    }
 };
 
-// Helper to pack data into bytes
+// Little-endian u64 stores and loads, a word at a time.
+inline void store_u64(uint8_t* out, uint64_t val) {
+    if constexpr (std::endian::native != std::endian::little) {
+        for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(val >> (i * 8));
+    } else {
+        std::memcpy(out, &val, 8);
+    }
+}
+
+inline uint64_t load_u64(const uint8_t* in) {
+    uint64_t val = 0;
+    if constexpr (std::endian::native != std::endian::little) {
+        for (int i = 0; i < 8; ++i) val |= static_cast<uint64_t>(in[i]) << (i * 8);
+    } else {
+        std::memcpy(&val, in, 8);
+    }
+    return val;
+}
+
+// Appends the same encoding to a growing vector.
 struct Packer {
     static void pack_u64(std::vector<uint8_t>& buf, uint64_t val) {
-        for (int i = 0; i < 8; ++i) {
-            buf.push_back((val >> (i * 8)) & 0xFF);
-        }
+        buf.resize(buf.size() + 8);
+        store_u64(buf.data() + buf.size() - 8, val);
     }
 
     static void pack_bytes(std::vector<uint8_t>& buf, const uint8_t* val, size_t size) {
@@ -29,4 +69,82 @@ struct Packer {
     }
 };
 
+// Writes the Packer encoding into a caller's buffer; throws
+// std::runtime_error if the buffer runs out.
+class Writer {
+public:
+    explicit Writer(std::span<uint8_t> out) : out_(out) {}
+
+    void write_u64(uint64_t val) { store_u64(take(8), val); }
+
+    void write_bytes(const uint8_t* val, size_t size) {
+        uint8_t* at = take(size);
+        if (size != 0) std::memcpy(at, val, size);
+    }
+
+    size_t position() const { return offset_; }
+
+private:
+    uint8_t* take(size_t size) {
+        if (size > out_.size() - offset_) throw std::runtime_error("Writer: output too small");
+        uint8_t* at = out_.data() + offset_;
+        offset_ += size;
+        return at;
+    }
+
+    std::span<uint8_t> out_;
+    size_t offset_ = 0;
+};
+
+// Reads back what Packer wrote; throws std::runtime_error on truncated input.
+class Unpacker {
+public:
+    explicit Unpacker(std::span<const uint8_t> data) : data_(data) {}
+
+    uint64_t unpack_u64() { return load_u64(take(8).data()); }
+
+    void unpack_bytes(uint8_t* val, size_t size) {
+        auto bytes = take(size);
+        std::memcpy(val, bytes.data(), size);
+    }
+
+    template<size_t N>
+    std::array<uint8_t, N> unpack_array() {
+        std::array<uint8_t, N> val;
+        unpack_bytes(val.data(), N);
+        return val;
+    }
+
+    std::vector<uint8_t> unpack_vector_bytes() {
+        auto bytes = take(unpack_u64());
+        return {bytes.begin(), bytes.end()};
+    }
+
+    // A length prefix for `size`-byte elements, checked against what is left.
+    uint64_t unpack_count(size_t size) {
+        uint64_t count = unpack_u64();
+        if (size != 0 && count > remaining() / size) throw std::runtime_error("Unpacker: count exceeds input");
+        return count;
+    }
+
+    void skip(uint64_t size) { take(size); }
+
+    size_t position() const { return offset_; }
+    // The bytes consumed since `from`, a value of position().
+    std::span<const uint8_t> consumed_since(size_t from) const { return data_.subspan(from, offset_ - from); }
+    size_t remaining() const { return data_.size() - offset_; }
+    bool done() const { return remaining() == 0; }
+
+private:
+    std::span<const uint8_t> take(uint64_t size) {
+        if (size > remaining()) throw std::runtime_error("Unpacker: truncated input");
+        auto bytes = data_.subspan(offset_, static_cast<size_t>(size));
+        offset_ += static_cast<size_t>(size);
+        return bytes;
+    }
+
+    std::span<const uint8_t> data_;
+    size_t offset_ = 0;
+};
+
 } // namespace narwhal::utils
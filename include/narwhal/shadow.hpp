@@ -0,0 +1,108 @@
+#pragma once
+
+#include "narwhal/consensus.hpp"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace narwhal::consensus {
+
+/**
+ * @brief Runs several engines side by side on one certificate stream.
+ *
+ * Every certificate received on `rx` is fanned out to one lane per engine.
+ * Each lane is a full Consensus instance with its own State and thread, so
+ * all engines see identical input with identical timing. The first lane is
+ * the reference: its commits are forwarded to `tx_output`. The other lanes
+ * are only measured.
+ *
+ * Divergence is tracked with a running hash of each commit sequence,
+ * checkpointed every CHECKPOINT commits. A lane agrees with the reference
+ * up to the last checkpoint at which the two hashes match, or throughout
+ * if it has committed as much as the reference with the same hash.
+ *
+ * Latency runs from fan-out to commit. A certificate's fan-out time is kept
+ * until every lane has committed it, or until it falls gc_depth rounds
+ * below the highest round any lane has committed, so certificates some
+ * lane never commits do not pile up; a lane that commits one after that
+ * goes unmeasured for it.
+ */
+class Shadow {
+public:
+    struct Report {
+        std::string engine;
+        uint64_t committed = 0;
+        double throughput = 0;        // committed certificates per second
+        double mean_latency_ms = 0;   // from fan-out to commit
+        double max_latency_ms = 0;
+        uint64_t agrees_until = 0;    // commits matching the reference sequence
+    };
+
+    using Engines = std::vector<std::pair<std::string, std::unique_ptr<ConsensusEngine>>>;
+
+    Shadow(config::Committee committee, Round gc_depth,
+           std::shared_ptr<utils::Channel<CertificateRef>> rx,
+           std::shared_ptr<utils::Channel<CertificateRef>> tx_output,
+           Engines engines,
+           config::Parameters parameters = {});
+
+    ~Shadow();
+
+    void spawn();
+    // Waits for every lane to commit what it will of the stream, which it
+    // does once `rx` is closed and drained.
+    void join();
+    std::vector<Report> report() const;
+    // Certificates whose fan-out time is still held.
+    size_t tracked() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint64_t CHECKPOINT = 1024;
+
+    struct Lane {
+        std::string engine;
+        std::shared_ptr<utils::Channel<CertificateRef>> rx;
+        std::shared_ptr<utils::Channel<CertificateRef>> committed;
+        std::unique_ptr<Consensus> consensus;
+        std::thread collector;
+
+        mutable std::mutex mutex;
+        uint64_t count = 0;
+        uint64_t samples = 0;
+        Clock::duration latency_sum{};
+        Clock::duration latency_max{};
+        uint64_t sequence_hash = 0;
+        std::vector<uint64_t> checkpoints;
+    };
+
+    // When a certificate entered the fan-out, and how many lanes have yet to commit it.
+    struct Arrival {
+        Clock::time_point time;
+        size_t pending;
+    };
+
+    void fan_out();
+    void collect(Lane& lane, bool reference);
+
+    std::shared_ptr<utils::Channel<CertificateRef>> rx;
+    std::shared_ptr<utils::Channel<CertificateRef>> tx_output;
+    // Feedback meant for the primary; the shadow has no primary, so it is discarded.
+    std::shared_ptr<utils::Channel<CertificateRef>> discard;
+    std::vector<std::unique_ptr<Lane>> lanes;
+
+    const Round gc_depth;
+    mutable std::mutex arrivals_mutex;
+    utils::FlatHashMap<crypto::Digest, Arrival> arrivals;
+    // The digests in `arrivals` by certificate round, to evict whole rounds.
+    std::map<Round, std::vector<crypto::Digest>> arrival_rounds;
+    // Highest round any lane has committed.
+    Round committed_round = 0;
+
+    Clock::time_point started;
+    std::thread dispatcher;
+    std::thread drain;
+};
+
+} // namespace narwhal::consensus
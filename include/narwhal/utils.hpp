@@ -1,49 +1,442 @@
 #pragma once
 
-#include <queue>
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <thread>
+#include <vector>
 
 namespace narwhal::utils {
 
+/**
+ * @brief Bounded multi-producer multi-consumer channel over a ring buffer.
+ *
+ * Each cell carries a sequence number that tells producers and consumers
+ * whether it is free or full, so neither side takes a lock. A side that
+ * finds the ring full (or empty) spins briefly, then parks on an atomic
+ * counter; the other side only issues a wakeup when someone is parked.
+ *
+ * close() keeps the mutex-era semantics: receivers drain what is queued and
+ * then get std::nullopt, and senders blocked on a full ring give up.
+ *
+ * Two watermarks give producers an earlier signal than a full ring. The
+ * channel becomes throttled once its depth reaches the high watermark and
+ * stays so until consumers drain it to the low watermark. Producers that
+ * can slow down call throttle() before sending.
+ */
 template<typename T>
 class Channel {
 public:
+    struct Stats {
+        size_t depth = 0;
+        size_t capacity = 0;
+        bool throttled = false;
+        // Sends that found the ring full and throttle() calls that had to wait.
+        uint64_t stalls = 0;
+        std::chrono::nanoseconds stall_time{0};
+    };
+
+    explicit Channel(size_t capacity = 4096) : Channel(capacity, 0, 0) {}
+
+    // Watermarks default to 3/4 and 1/4 of the capacity.
+    Channel(size_t capacity, size_t high_watermark, size_t low_watermark)
+        : mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), cells(mask + 1),
+          high_watermark(high_watermark ? std::min(high_watermark, mask + 1) : (mask + 1) * 3 / 4),
+          low_watermark(std::min(low_watermark ? low_watermark : (mask + 1) / 4, this->high_watermark - 1)) {
+        for (size_t i = 0; i <= mask; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
     void send(T value) {
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            queue.push(std::move(value));
+        push(value);
+        filled_up();
+    }
+
+    // Sends every value with a single wakeup for the receivers.
+    void send_batch(std::span<const T> values) {
+        for (const T& value : values) {
+            T copy = value;
+            push(copy);
         }
-        cv.notify_one();
+        filled_up();
     }
 
-    std::optional<T> receive() {
-        std::unique_lock<std::mutex> lock(mutex);
-        cv.wait(lock, [this] { return !queue.empty() || closed; });
-        
-        if (queue.empty() && closed) {
-            return std::nullopt;
+    // Sends the leading values that fit without waiting, with a single
+    // wakeup, and returns how many were sent. As with send(), a closed
+    // channel drops values rather than keep the caller waiting.
+    size_t try_send_batch(std::span<const T> values) {
+        size_t sent = 0;
+        for (const T& value : values) {
+            T copy = value;
+            if (!try_push(copy)) break;
+            ++sent;
         }
+        if (sent != 0) filled_up();
+        return is_closed() ? values.size() : sent;
+    }
 
-        T value = std::move(queue.front());
-        queue.pop();
-        return value;
+    std::optional<T> receive() {
+        T value;
+        return receive_batch({&value, 1}) ? std::optional<T>(std::move(value)) : std::nullopt;
+    }
+
+    // Blocks until at least one value is available, then moves out as many
+    // as fit. Returns 0 once the channel is closed and drained.
+    size_t receive_batch(std::span<T> out) {
+        if (out.empty()) return 0;
+        size_t count = 0;
+        wait(filled, [&] { return (count = pop(out)) != 0 || closed.load(std::memory_order_acquire); });
+        if (count == 0) count = pop(out);
+        if (count != 0) drained_down();
+        return count;
+    }
+
+    // As receive_batch(), but gives up at `deadline`: returns 0 if nothing
+    // arrived by then, or once the channel is closed and drained.
+    size_t receive_batch_until(std::span<T> out, std::chrono::steady_clock::time_point deadline) {
+        if (out.empty()) return 0;
+        size_t count = 0;
+        wait_until(filled, [&] { return (count = pop(out)) != 0 || closed.load(std::memory_order_acquire); }, deadline);
+        if (count == 0) count = pop(out);
+        if (count != 0) drained_down();
+        return count;
+    }
+
+    // Moves out whatever is available without blocking.
+    size_t try_receive_batch(std::span<T> out) {
+        size_t count = pop(out);
+        if (count != 0) drained_down();
+        return count;
+    }
+
+    // Blocks while the channel is throttled, i.e. from the high watermark
+    // until consumers drain it to the low one, or until it closes.
+    void throttle() {
+        if (!pressured.load(std::memory_order_acquire)) return;
+        auto start = std::chrono::steady_clock::now();
+        wait(drained, [&] { return relieved() || closed.load(std::memory_order_acquire); });
+        stalled(start);
     }
 
     void close() {
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            closed = true;
+        closed.store(true, std::memory_order_release);
+        wake(filled);
+        wake(drained);
+        notify(listener);
+        notify(room_listener);
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const {
+        size_t first = head.load();
+        return tail.load() - first;
+    }
+    bool empty() const { return head.load() == tail.load(); }
+    bool is_closed() const { return closed.load(std::memory_order_acquire); }
+    bool throttled() const { return pressured.load(std::memory_order_acquire); }
+
+    Stats stats() const {
+        return {size(), capacity(), throttled(), stalls.load(std::memory_order_relaxed),
+                std::chrono::nanoseconds(stall_ns.load(std::memory_order_relaxed))};
+    }
+
+    // Called on the sending thread after every send and on close, so a
+    // consumer can be scheduled instead of parking a thread on receive().
+    // Replacing the listener waits until no call to the previous one is in
+    // progress, after which it may be destroyed.
+    void set_listener(const std::function<void()>* callback) {
+        listener.store(callback);
+        while (notifying.load() != 0) std::this_thread::yield();
+    }
+
+    // Called on the receiving thread whenever values are taken out (and on
+    // close), so a producer that found the ring full can be rescheduled
+    // instead of waiting. Replaced like the send listener.
+    void set_room_listener(const std::function<void()>* callback) {
+        room_listener.store(callback);
+        while (notifying.load() != 0) std::this_thread::yield();
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value{};
+    };
+
+    // Parking spot for one side of the channel. Atomic waits cannot time
+    // out, so deadline-bounded waiters park on the condition variable.
+    struct Signal {
+        std::atomic<uint32_t> epoch{0};
+        std::atomic<uint32_t> sleepers{0};
+        std::atomic<uint32_t> timed_sleepers{0};
+        std::mutex mutex;
+        std::condition_variable timed;
+    };
+
+    static constexpr int SPIN_LIMIT = 64;
+
+    // Blocks while the ring is full; drops the value if the channel closes meanwhile.
+    void push(T& value) {
+        if (try_push(value)) return;
+        auto start = std::chrono::steady_clock::now();
+        wait(drained, [&] { return try_push(value) || closed.load(std::memory_order_acquire); });
+        stalled(start);
+    }
+
+    void stalled(std::chrono::steady_clock::time_point start) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        stalls.fetch_add(1, std::memory_order_relaxed);
+        stall_ns.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    }
+
+    void filled_up() {
+        if (!pressured.load(std::memory_order_relaxed) && size() >= high_watermark) {
+            pressured.store(true, std::memory_order_release);
+        }
+        wake(filled);
+        notify(listener);
+    }
+
+    void drained_down() {
+        relieved();
+        wake(drained);
+        notify(room_listener);
+    }
+
+    // Clears the throttle once the depth is at the low watermark. Also run by
+    // throttled producers, in case a sender raised the flag just after the
+    // consumer's check.
+    bool relieved() {
+        if (!pressured.load(std::memory_order_acquire)) return true;
+        if (size() > low_watermark) return false;
+        pressured.store(false, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
         }
-        cv.notify_all();
     }
 
+    size_t pop(std::span<T> out) {
+        size_t count = 0;
+        while (count < out.size() && try_pop(out[count])) ++count;
+        return count;
+    }
+
+    bool try_pop(T& out) {
+        size_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (diff == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.value = T{};
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Spins on `ready`, then parks on `signal` until another thread wakes it.
+    template<typename Ready>
+    void wait(Signal& signal, Ready ready) {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (ready()) return;
+            if (i >= SPIN_LIMIT / 2) std::this_thread::yield();
+        }
+        for (;;) {
+            uint32_t epoch = signal.epoch.load();
+            signal.sleepers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready()) {
+                signal.sleepers.fetch_sub(1);
+                return;
+            }
+            signal.epoch.wait(epoch);
+            signal.sleepers.fetch_sub(1);
+        }
+    }
+
+    // As wait(), but gives up at `deadline`; returns whether `ready` held.
+    template<typename Ready>
+    bool wait_until(Signal& signal, Ready ready, std::chrono::steady_clock::time_point deadline) {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            if (ready()) return true;
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            if (i >= SPIN_LIMIT / 2) std::this_thread::yield();
+        }
+        for (;;) {
+            uint32_t epoch = signal.epoch.load();
+            signal.sleepers.fetch_add(1);
+            signal.timed_sleepers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool done = ready();
+            bool woken = done;
+            if (!done) {
+                std::unique_lock<std::mutex> lock(signal.mutex);
+                woken = signal.timed.wait_until(lock, deadline, [&] { return signal.epoch.load() != epoch; });
+            }
+            signal.timed_sleepers.fetch_sub(1);
+            signal.sleepers.fetch_sub(1);
+            if (done) return true;
+            if (!woken) return ready();
+        }
+    }
+
+    void notify(const std::atomic<const std::function<void()>*>& which) {
+        if (!which.load()) return;
+        notifying.fetch_add(1);
+        if (const auto* callback = which.load()) (*callback)();
+        notifying.fetch_sub(1);
+    }
+
+    void wake(Signal& signal) {
+        signal.epoch.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (signal.sleepers.load() == 0) return;
+        signal.epoch.notify_all();
+        if (signal.timed_sleepers.load() != 0) {
+            // A timed waiter between its epoch check and its wait holds the mutex.
+            { std::lock_guard<std::mutex> lock(signal.mutex); }
+            signal.timed.notify_all();
+        }
+    }
+
+    const size_t mask;
+    std::vector<Cell> cells;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) Signal filled;
+    alignas(64) Signal drained;
+    std::atomic<bool> closed{false};
+    const size_t high_watermark;
+    const size_t low_watermark;
+    std::atomic<bool> pressured{false};
+    std::atomic<uint64_t> stalls{0};
+    std::atomic<uint64_t> stall_ns{0};
+    std::atomic<const std::function<void()>*> listener{nullptr};
+    std::atomic<const std::function<void()>*> room_listener{nullptr};
+    std::atomic<uint32_t> notifying{0};
+};
+
+/**
+ * @brief Sends into a bounded channel from a task that must not block.
+ *
+ * An Executor task that waits for room in a channel holds its worker, and
+ * if the channel's consumer needs that worker (always so with one thread)
+ * nothing moves again. An Outbox sends what fits and keeps the rest, in
+ * order, for flush(). Once flush() leaves values behind, `on_room` runs on
+ * the receiving thread the next time values are taken out, so the owner
+ * can schedule another flush instead of polling. One Outbox per channel:
+ * it is the channel's room listener.
+ */
+template<typename T>
+class Outbox {
+public:
+    Outbox(std::shared_ptr<Channel<T>> channel, std::function<void()> on_room)
+        : channel(std::move(channel)), on_room(std::move(on_room)),
+          listener([this] { if (waiting.exchange(false)) this->on_room(); }) {
+        this->channel->set_room_listener(&listener);
+    }
+
+    Outbox(const Outbox&) = delete;
+    Outbox& operator=(const Outbox&) = delete;
+
+    ~Outbox() { detach(); }
+
+    // Sends what fits behind anything still waiting and keeps the rest.
+    void send_batch(std::span<const T> values) {
+        size_t sent = pending.empty() ? channel->try_send_batch(values) : 0;
+        pending.insert(pending.end(), values.begin() + sent, values.end());
+    }
+
+    // Sends what is waiting; returns true once nothing is left. Otherwise
+    // on_room is due.
+    bool flush() {
+        while (!pending.empty()) {
+            if (send_pending()) continue;
+            waiting.store(true);
+            // Room freed before the flag went up raised no call.
+            if (!send_pending()) return false;
+        }
+        waiting.store(false);
+        return true;
+    }
+
+    bool empty() const { return pending.empty(); }
+
+    // Stops calling on_room, waiting for a call in progress.
+    void detach() { channel->set_room_listener(nullptr); }
+
+private:
+    bool send_pending() {
+        size_t sent = channel->try_send_batch(pending);
+        pending.erase(pending.begin(), pending.begin() + sent);
+        return sent != 0;
+    }
+
+    std::shared_ptr<Channel<T>> channel;
+    std::function<void()> on_room;
+    std::function<void()> listener;
+    std::atomic<bool> waiting{false};
+    std::vector<T> pending;
+};
+
+/**
+ * @brief Destroys values on a background thread.
+ *
+ * Handing large structures to a Reclaimer keeps their destructors (and the
+ * frees they trigger) off the caller's critical path.
+ */
+template<typename T>
+class Reclaimer {
+public:
+    Reclaimer() : thread([this] { while (queue.receive()) {} }) {}
+
+    ~Reclaimer() {
+        queue.close();
+        thread.join();
+    }
+
+    void retire(T value) { queue.send(std::move(value)); }
+
 private:
-    std::queue<T> queue;
-    std::mutex mutex;
-    std::condition_variable cv;
-    bool closed = false;
+    Channel<T> queue;
+    std::thread thread;
 };
 
 } // namespace narwhal::utils
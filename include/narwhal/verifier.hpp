@@ -0,0 +1,93 @@
+#pragma once
+
+#include "narwhal/certificate_view.hpp"
+#include "narwhal/compact_certificate.hpp"
+#include "narwhal/consensus_engines.hpp"
+#include "narwhal/utils.hpp"
+#include "narwhal/executor.hpp"
+#include <atomic>
+#include <memory>
+
+namespace narwhal::consensus {
+
+/**
+ * @brief Checks certificates on the executor before they reach Consensus.
+ *
+ * The stage drains a batch from `rx` and checks each certificate's quorum:
+ * a signer bitmap over this committee whose members hold at least
+ * quorum_threshold() stake. It then verifies every vote signature in the
+ * batch against the certificate digest, with up to `workers` executor tasks
+ * claiming one vote at a time, so a single large certificate is spread
+ * across them. An aggregated certificate is one job, checked with
+ * `aggregates`; without a scheme such certificates are dropped.
+ * Certificates that pass are forwarded to `tx` in arrival order; the rest
+ * are dropped. With a `filter`, each certificate that passes is recorded
+ * in it, and dropped instead if the filter refuses it (its author already
+ * holds the round, or the round left the window). With `slots`, each
+ * forwarded certificate is also recorded there for compact decoding. When
+ * `rx` closes, the stage closes `tx`.
+ */
+class Verifier {
+public:
+    Verifier(config::Committee committee, utils::Executor& executor, size_t workers,
+             std::shared_ptr<utils::Channel<CertificateRef>> rx,
+             std::shared_ptr<utils::Channel<CertificateRef>> tx,
+             size_t max_batch_size = 256,
+             const crypto::AggregateScheme* aggregates = nullptr,
+             InboundFilter* filter = nullptr,
+             SlotTable* slots = nullptr);
+
+    ~Verifier();
+
+    void spawn();
+
+    // Whether the signers are members of this committee holding a quorum of stake.
+    static bool has_quorum(const Certificate& certificate, const config::Committee& committee);
+
+private:
+    struct Job {
+        uint32_t certificate;
+        uint32_t vote;    // index into the certificate's signatures
+        uint32_t signer;  // committee index; unused for an aggregate
+    };
+
+    // One batch in flight. Helper tasks hold a reference, so one that starts
+    // after the batch is finished finds no job left and touches nothing else.
+    struct Pass {
+        std::vector<CertificateRef> certificates;
+        std::vector<std::vector<uint8_t>> messages;
+        std::vector<Job> jobs;
+        const config::Committee* committee;
+        const crypto::AggregateScheme* aggregates;
+        std::unique_ptr<std::atomic<bool>[]> rejected;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+
+        void work();
+    };
+
+    void drain();
+    void verify(size_t count);
+    // Sends held back certificates; if some still do not fit, pauses the
+    // consumer until `tx` frees room.
+    bool flushed();
+
+    config::Committee committee;
+    utils::Executor& executor;
+    size_t workers;
+    std::shared_ptr<utils::Channel<CertificateRef>> rx;
+    std::shared_ptr<utils::Channel<CertificateRef>> tx;
+    const crypto::AggregateScheme* aggregates;
+    InboundFilter* filter;
+    SlotTable* slots;
+    std::vector<CertificateRef> batch;
+    bool closed = false;
+
+    // Verified certificates that did not fit in `tx`; the stage never
+    // waits for room on the executor.
+    std::unique_ptr<utils::Outbox<CertificateRef>> outbox;
+    // Declared last so it detaches before the state drain() uses.
+    std::unique_ptr<utils::Consumer<CertificateRef>> consumer;
+};
+
+} // namespace narwhal::consensus
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "narwhal/bitmap.hpp"
+#include "narwhal/config.hpp"
+#include "narwhal/crypto.hpp"
+#include "narwhal/serializable.hpp"
+#include <span>
+#include <vector>
+
+namespace narwhal::consensus {
+
+/**
+ * @brief The signatures certifying a header, keyed by committee index.
+ *
+ * Signers are a bitmap over the committee's dense indices rather than a list
+ * of public keys. Individual votes keep one signature per signer in index
+ * order; aggregated votes keep a single signature covering every signer.
+ * For a 100-member committee a quorum encodes in about 4.3 KB individually
+ * and under 100 bytes aggregated, against 6.4 KB as (key, signature) pairs.
+ */
+class Votes : public utils::Serializable {
+public:
+    using Index = config::Committee::Index;
+
+    enum class Mode : uint8_t {
+        INDIVIDUAL = 0,
+        AGGREGATE = 1
+    };
+
+    Votes() = default;
+    // No signers yet, over a committee of `width` members.
+    explicit Votes(size_t width) : signers_(width) {}
+
+    // Adds `signer`'s own signature. Returns false if it is out of range or
+    // already signed, or if these votes are aggregated.
+    bool add(Index signer, const crypto::Signature& signature);
+
+    // The same signers with their signatures folded into one.
+    Votes aggregate(const crypto::AggregateScheme& scheme) const;
+
+    Mode mode() const { return mode_; }
+    size_t width() const { return signers_.size(); }
+    const utils::Bitmap& signers() const { return signers_; }
+    bool signed_by(Index signer) const { return signer < width() && signers_.test(signer); }
+    // INDIVIDUAL: one per signer in index order. AGGREGATE: exactly one.
+    std::span<const crypto::Signature> signatures() const { return signatures_; }
+
+    size_t serialized_size() const override;
+    void serialize_into(std::span<uint8_t> out) const override;
+    // Throws std::runtime_error on malformed input, including set bits past
+    // the width and an unknown mode.
+    static Votes deserialize(utils::Unpacker& unpacker);
+
+    bool operator==(const Votes& other) const {
+        return mode_ == other.mode_ && signers_ == other.signers_ && signatures_ == other.signatures_;
+    }
+
+private:
+    Mode mode_ = Mode::INDIVIDUAL;
+    utils::Bitmap signers_;
+    std::vector<crypto::Signature> signatures_;
+};
+
+} // namespace narwhal::consensus
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace narwhal::network {
+
+/**
+ * @brief Byte limits on a connection's write queue
+ */
+struct WriteLimits {
+    size_t high_watermark = 4 << 20;
+    size_t low_watermark = 1 << 20;
+    size_t capacity = 16 << 20;
+};
+
+// A framed message (MessageHeader followed by the payload), shared by every
+// connection it is queued on.
+using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+/**
+ * @brief A connection's outgoing frames, bounded in bytes
+ *
+ * Congested from the push that reaches the high watermark until the pop
+ * that brings it down to the low one. A frame that would take it past
+ * capacity is refused, unless the queue is empty, so a single frame larger
+ * than the capacity still goes out. Not thread-safe, apart from
+ * congested(): the owner serializes the rest.
+ */
+class WriteQueue {
+public:
+    explicit WriteQueue(WriteLimits limits = {}) : limits_(limits) {}
+
+    // Returns false, leaving the queue as it was, if the frame does not fit.
+    bool push(Frame frame) {
+        if (bytes_ + frame->size() > limits_.capacity && !frames_.empty()) return false;
+        bytes_ += frame->size();
+        frames_.push(std::move(frame));
+        if (bytes_ >= limits_.high_watermark) congested_.store(true, std::memory_order_release);
+        return true;
+    }
+
+    const Frame& front() const { return frames_.front(); }
+
+    // Drops the front frame once it has been written.
+    void pop() {
+        bytes_ -= frames_.front()->size();
+        frames_.pop();
+        if (bytes_ <= limits_.low_watermark) congested_.store(false, std::memory_order_release);
+    }
+
+    bool empty() const { return frames_.empty(); }
+    size_t bytes() const { return bytes_; }
+    bool congested() const { return congested_.load(std::memory_order_acquire); }
+
+private:
+    WriteLimits limits_;
+    std::queue<Frame> frames_;
+    size_t bytes_ = 0;
+    std::atomic<bool> congested_{false};
+};
+
+} // namespace narwhal::network
@@ -1,4 +1,5 @@
 #include "narwhal/async_network.hpp"
+#include <atomic>
 #include <iostream>
 
 namespace narwhal::network {
@@ -8,7 +9,15 @@ namespace narwhal::network {
 // ============================================================================
 
 std::vector<uint8_t> MessageHeader::serialize() const {
-    std::vector<uint8_t> buffer(10);
+    std::vector<uint8_t> buffer(SIZE);
+    serialize_into(buffer);
+    return buffer;
+}
+
+void MessageHeader::serialize_into(std::span<uint8_t> buffer) const {
+    if (buffer.size() < SIZE) {
+        throw std::runtime_error("Header buffer too small");
+    }
     
     // Magic (4 bytes, big-endian)
     buffer[0] = (magic >> 24) & 0xFF;
@@ -27,12 +36,10 @@ std::vector<uint8_t> MessageHeader::serialize() const {
     buffer[7] = (length >> 16) & 0xFF;
     buffer[8] = (length >> 8) & 0xFF;
     buffer[9] = length & 0xFF;
-    
-    return buffer;
 }
 
 MessageHeader MessageHeader::deserialize(const std::vector<uint8_t>& data) {
-    if (data.size() < 10) {
+    if (data.size() < SIZE) {
         throw std::runtime_error("Invalid header size");
     }
     
@@ -62,13 +69,14 @@ MessageHeader MessageHeader::deserialize(const std::vector<uint8_t>& data) {
 // Connection Implementation
 // ============================================================================
 
-Connection::Connection(asio::io_context& io_context, ssl::context& ssl_context)
-    : socket_(io_context, ssl_context) {
+Connection::Connection(asio::io_context& io_context, ssl::context& ssl_context, WriteLimits limits)
+    : socket_(io_context, ssl_context), read_pause_(io_context), write_queue_(limits) {
     read_buffer_.resize(65536); // 64KB read buffer
 }
 
-void Connection::start(MessageHandler handler) {
+void Connection::start(MessageHandler handler, Backpressure backpressure) {
     message_handler_ = std::move(handler);
+    backpressure_ = std::move(backpressure);
     do_handshake();
 }
 
@@ -86,6 +94,13 @@ void Connection::do_handshake() {
 
 void Connection::do_read_header() {
     auto self = shared_from_this();
+    if (backpressure_ && backpressure_()) {
+        read_pause_.expires_after(READ_PAUSE);
+        read_pause_.async_wait([this, self](const boost::system::error_code& ec) {
+            if (!ec) do_read_header();
+        });
+        return;
+    }
     asio::async_read(socket_, asio::buffer(read_buffer_, 10),
         [this, self](const boost::system::error_code& ec, std::size_t) {
             if (!ec) {
@@ -108,15 +123,13 @@ void Connection::do_read_body(const MessageHeader& header) {
     asio::async_read(socket_, asio::buffer(read_buffer_, header.length),
         [this, self, header](const boost::system::error_code& ec, std::size_t) {
             if (!ec) {
-                std::vector<uint8_t> payload(read_buffer_.begin(), 
-                                            read_buffer_.begin() + header.length);
-                message_handler_(header.type, std::move(payload));
+                message_handler_(header.type, std::span<const uint8_t>(read_buffer_.data(), header.length));
                 do_read_header(); // Continue reading
             }
         });
 }
 
-void Connection::send(MessageType type, const std::vector<uint8_t>& payload) {
+bool Connection::send(MessageType type, const std::vector<uint8_t>& payload) {
     MessageHeader header{
         MessageHeader::MAGIC,
         MessageHeader::VERSION,
@@ -124,25 +137,30 @@ void Connection::send(MessageType type, const std::vector<uint8_t>& payload) {
         static_cast<uint32_t>(payload.size())
     };
     
-    auto header_bytes = header.serialize();
-    std::vector<uint8_t> message;
-    message.reserve(header_bytes.size() + payload.size());
-    message.insert(message.end(), header_bytes.begin(), header_bytes.end());
-    message.insert(message.end(), payload.begin(), payload.end());
-    
-    {
-        std::lock_guard<std::mutex> lock(write_mutex_);
-        bool write_in_progress = !write_queue_.empty();
-        write_queue_.push(std::move(message));
-        if (!write_in_progress) {
-            do_write();
-        }
+    auto message = std::make_shared<std::vector<uint8_t>>(MessageHeader::SIZE + payload.size());
+    header.serialize_into(*message);
+    std::copy(payload.begin(), payload.end(), message->begin() + MessageHeader::SIZE);
+    return send(Frame(std::move(message)));
+}
+
+bool Connection::send(Frame frame) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    bool write_in_progress = !write_queue_.empty();
+    if (!write_queue_.push(std::move(frame))) return false;
+    if (!write_in_progress) {
+        do_write();
     }
+    return true;
+}
+
+size_t Connection::queued_bytes() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return write_queue_.bytes();
 }
 
 void Connection::do_write() {
     auto self = shared_from_this();
-    asio::async_write(socket_, asio::buffer(write_queue_.front()),
+    asio::async_write(socket_, asio::buffer(*write_queue_.front()),
         [this, self](const boost::system::error_code& ec, std::size_t) {
             if (!ec) {
                 std::lock_guard<std::mutex> lock(write_mutex_);
@@ -159,6 +177,40 @@ void Connection::close() {
     socket_.lowest_layer().close(ec);
 }
 
+// ============================================================================
+// BufferPool Implementation
+// ============================================================================
+
+Frame BufferPool::frame(MessageType type, const utils::Serializable& message) {
+    const size_t size = message.serialized_size();
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A buffer only the pool still references is free: every frame
+        // handed out from it has been written and released.
+        for (size_t i = 0; i < buffers_.size() && !buffer; ++i) {
+            auto& candidate = buffers_[(next_ + i) % buffers_.size()];
+            if (candidate.use_count() == 1) {
+                // use_count() is a relaxed read; order the last writer's
+                // accesses before ours.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                buffer = candidate;
+                next_ = (next_ + i + 1) % buffers_.size();
+            }
+        }
+        if (!buffer) {
+            buffer = std::make_shared<std::vector<uint8_t>>();
+            if (buffers_.size() < max_buffers_) buffers_.push_back(buffer);
+        }
+    }
+    
+    buffer->resize(MessageHeader::SIZE + size);
+    MessageHeader header{MessageHeader::MAGIC, MessageHeader::VERSION, type, static_cast<uint32_t>(size)};
+    header.serialize_into(*buffer);
+    message.serialize_into(std::span<uint8_t>(*buffer).subspan(MessageHeader::SIZE));
+    return buffer;
+}
+
 // ============================================================================
 // AsyncNetwork Implementation
 // ============================================================================
@@ -192,6 +244,9 @@ void AsyncNetwork::start() {
     // Start IO threads
     for (size_t i = 0; i < config_.io_threads; ++i) {
         io_threads_.emplace_back([this]() {
+            if (!utils::place_current_thread(config_.io_placement)) {
+                std::cerr << "[AsyncNetwork] Could not apply io thread placement" << std::endl;
+            }
             io_context_.run();
         });
     }
@@ -224,65 +279,195 @@ void AsyncNetwork::stop() {
 }
 
 void AsyncNetwork::do_accept() {
-    auto connection = std::make_shared<Connection>(io_context_, ssl_context_);
+    auto connection = std::make_shared<Connection>(io_context_, ssl_context_, config_.write_limits);
     
     acceptor_.async_accept(connection->socket(),
         [this, connection](const boost::system::error_code& ec) {
             if (!ec) {
-                connection->start([this](MessageType type, std::vector<uint8_t> data) {
-                    handle_message("", type, data);
-                });
+                // The handler is owned by the connection, so a plain
+                // reference back to it cannot dangle.
+                connection->start([this, from = connection.get()](MessageType type, std::span<const uint8_t> data) {
+                    handle_message(*from, type, data);
+                }, config_.backpressure);
             }
             do_accept(); // Continue accepting
         });
 }
 
-void AsyncNetwork::send_certificate(const std::string& peer_address,
+bool AsyncNetwork::send_certificate(const std::string& peer_address,
                                     const consensus::Certificate& cert) {
     std::lock_guard<std::mutex> lock(connections_mutex_);
     auto it = connections_.find(peer_address);
-    if (it != connections_.end()) {
-        auto payload = cert.serialize();
-        it->second->send(MessageType::CERTIFICATE, payload);
-        
-        std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    if (it == connections_.end()) return false;
+    auto frame = encode(cert);
+    bool sent = it->second->send(frame);
+    
+    std::lock_guard<std::mutex> stats_lock(stats_mutex_);
+    if (sent) {
         stats_.messages_sent++;
-        stats_.bytes_sent += payload.size();
+        stats_.bytes_sent += frame->size() - MessageHeader::SIZE;
+    } else {
+        stats_.messages_dropped++;
     }
+    return sent;
 }
 
-void AsyncNetwork::broadcast_certificate(const consensus::Certificate& cert) {
-    auto payload = cert.serialize();
+size_t AsyncNetwork::broadcast_certificate(const consensus::Certificate& cert) {
+    // Serialized once; every connection queues the same frame.
+    auto frame = encode(cert);
     
     std::lock_guard<std::mutex> lock(connections_mutex_);
+    size_t sent = 0;
     for (auto& [addr, conn] : connections_) {
-        conn->send(MessageType::CERTIFICATE, payload);
+        if (conn->send(frame)) sent++;
     }
     
     std::lock_guard<std::mutex> stats_lock(stats_mutex_);
-    stats_.messages_sent += connections_.size();
-    stats_.bytes_sent += payload.size() * connections_.size();
+    stats_.messages_sent += sent;
+    stats_.bytes_sent += (frame->size() - MessageHeader::SIZE) * sent;
+    stats_.messages_dropped += connections_.size() - sent;
+    return sent;
 }
 
-void AsyncNetwork::on_certificate(CertificateHandler handler) {
+Frame AsyncNetwork::encode(const consensus::Certificate& cert) {
+    auto* slots = config_.parent_slots;
+    if (!slots) return send_buffers_.frame(MessageType::CERTIFICATE, cert);
+
+    // Our own certificate fills our slot, so peers' next round can refer to it.
+    slots->insert(cert);
+    auto frame = send_buffers_.frame(MessageType::COMPACT_CERTIFICATE, consensus::CompactCertificate(cert, *slots));
+    std::lock_guard<std::mutex> lock(recent_mutex_);
+    for (const auto& sent : recent_) {
+        if (sent.author == cert.origin() && sent.round == cert.round()) return frame;
+    }
+    if (recent_.size() == RECENT_CAPACITY) recent_.pop_front();
+    recent_.push_back({cert.origin(), cert.round(), frame});
+    return frame;
+}
+
+void AsyncNetwork::on_certificate(CertificateHandler handler, CertificateFilter filter) {
     certificate_handler_ = std::move(handler);
+    certificate_filter_ = std::move(filter);
 }
 
-void AsyncNetwork::handle_message(const std::string& peer, MessageType type,
-                                  const std::vector<uint8_t>& data) {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.messages_received++;
-    stats_.bytes_received += data.size();
+void AsyncNetwork::handle_message(Connection& from, MessageType type, std::span<const uint8_t> data) {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.messages_received++;
+        stats_.bytes_received += data.size();
+    }
     
-    if (type == MessageType::CERTIFICATE && certificate_handler_) {
-        // TODO: Deserialize certificate and call handler
-        // This requires implementing Certificate::deserialize()
+    switch (type) {
+    case MessageType::CERTIFICATE:
+        handle_certificate(data);
+        break;
+    case MessageType::COMPACT_CERTIFICATE: {
+        if (!config_.parent_slots) {
+            std::cerr << "Compact certificate without a slot table" << std::endl;
+            break;
+        }
+        // Expanded into a per-thread buffer that only ever grows.
+        thread_local std::vector<uint8_t> expanded;
+        try {
+            if (consensus::expand_compact(data, *config_.parent_slots, expanded)) {
+                handle_certificate(expanded);
+                break;
+            }
+            // A parent we have not verified, or a slot we hold for another
+            // certificate: ask the sender for the full encoding, identified by
+            // author and round.
+            auto [author, round] = consensus::compact_origin(data);
+            std::vector<uint8_t> request(author.begin(), author.end());
+            utils::Packer::pack_u64(request, round);
+            from.send(MessageType::SYNC_REQUEST, request);
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.sync_requests++;
+        } catch (const std::exception& e) {
+            std::cerr << "Certificate parse error: " << e.what() << std::endl;
+        }
+        break;
+    }
+    case MessageType::SYNC_REQUEST:
+        handle_sync_request(from, data);
+        break;
+    default:
+        break;
+    }
+}
+
+void AsyncNetwork::handle_certificate(std::span<const uint8_t> data) {
+    if (!certificate_handler_) return;
+    // Parse and filter in place; only accepted certificates are copied
+    // out of the read buffer.
+    std::shared_ptr<const consensus::Certificate> certificate;
+    try {
+        auto view = consensus::CertificateView::parse(data);
+        if (certificate_filter_ && !certificate_filter_(view)) {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            stats_.certificates_filtered++;
+            return;
+        }
+        certificate = std::make_shared<const consensus::Certificate>(view.materialize());
+    } catch (const std::exception& e) {
+        std::cerr << "Certificate parse error: " << e.what() << std::endl;
+        return;
+    }
+    if (config_.executor) {
+        config_.executor->post([this, certificate] { certificate_handler_(*certificate); });
+    } else {
+        certificate_handler_(*certificate);
     }
 }
 
+void AsyncNetwork::handle_sync_request(Connection& from, std::span<const uint8_t> data) {
+    if (!config_.parent_slots) return;
+    std::pair<crypto::PublicKey, consensus::Round> origin;
+    try {
+        origin = consensus::compact_origin(data);
+    } catch (const std::exception& e) {
+        std::cerr << "Sync request parse error: " << e.what() << std::endl;
+        return;
+    }
+    Frame frame;
+    {
+        std::lock_guard<std::mutex> lock(recent_mutex_);
+        for (const auto& sent : recent_) {
+            if (sent.author == origin.first && sent.round == origin.second) frame = sent.frame;
+        }
+    }
+    // Our own table resolved the parents when the frame was encoded, and
+    // slots are never overwritten, so it expands again unless the round has
+    // left the table.
+    std::vector<uint8_t> full;
+    if (frame && consensus::expand_compact(std::span<const uint8_t>(*frame).subspan(MessageHeader::SIZE),
+                                           *config_.parent_slots, full)) {
+        from.send(MessageType::CERTIFICATE, full);
+    }
+}
+
+bool AsyncNetwork::congested() const {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (const auto& [addr, conn] : connections_) {
+        if (conn->congested()) return true;
+    }
+    return false;
+}
+
 AsyncNetwork::Stats AsyncNetwork::get_stats() const {
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    return stats_;
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats = stats_;
+    }
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    stats.active_connections = connections_.size();
+    stats.write_queue_bytes = 0;
+    stats.congested_connections = 0;
+    for (const auto& [addr, conn] : connections_) {
+        stats.write_queue_bytes += conn->queued_bytes();
+        if (conn->congested()) stats.congested_connections++;
+    }
+    return stats;
 }
 
 } // namespace narwhal::network
@@ -0,0 +1,146 @@
+#include "narwhal/certificate_view.hpp"
+#include <bit>
+#include <limits>
+
+namespace narwhal::consensus {
+
+// --- HeaderView ---
+
+HeaderView HeaderView::parse(utils::Unpacker& unpacker) {
+    HeaderView view;
+    const size_t start = unpacker.position();
+    unpacker.skip(sizeof(crypto::PublicKey));
+    view.round_ = unpacker.unpack_u64();
+    view.parent_count_ = unpacker.unpack_count(sizeof(crypto::Digest));
+    unpacker.skip(view.parent_count_ * sizeof(crypto::Digest));
+    view.payload_count_ = unpacker.unpack_count(PAYLOAD_ENTRY);
+    view.payload_offset_ = unpacker.position() - start;
+    unpacker.skip(view.payload_count_ * PAYLOAD_ENTRY);
+    view.bytes_ = unpacker.consumed_since(start);
+
+    // Same checks as Header::deserialize, so materialize() cannot fail.
+    for (size_t i = 0; i < view.payload_count_; ++i) {
+        auto entry = view.bytes_.subspan(view.payload_offset_ + i * PAYLOAD_ENTRY, PAYLOAD_ENTRY);
+        if (utils::load_u64(entry.data() + sizeof(crypto::Digest)) > std::numeric_limits<WorkerId>::max()) {
+            throw std::runtime_error("Header: worker id out of range");
+        }
+        if (i > 0 && std::memcmp(entry.data() - PAYLOAD_ENTRY, entry.data(), sizeof(crypto::Digest)) >= 0) {
+            throw std::runtime_error("Header: payload not in canonical order");
+        }
+    }
+    return view;
+}
+
+Header HeaderView::materialize() const {
+    utils::Unpacker unpacker(bytes_);
+    return Header::deserialize(unpacker);
+}
+
+// --- CertificateView ---
+
+CertificateView CertificateView::parse(std::span<const uint8_t> data) {
+    utils::Unpacker unpacker(data);
+    CertificateView view = parse(unpacker);
+    if (!unpacker.done()) throw std::runtime_error("Certificate: trailing bytes");
+    return view;
+}
+
+CertificateView CertificateView::parse(utils::Unpacker& unpacker) {
+    CertificateView view;
+    view.header_ = HeaderView::parse(unpacker);
+
+    // Same checks as Votes::deserialize, so materialize() cannot fail.
+    const size_t start = unpacker.position();
+    const uint64_t width = unpacker.unpack_u64();
+    if (width > unpacker.remaining() * 8) throw std::runtime_error("Votes: width exceeds input");
+    view.signer_width_ = static_cast<size_t>(width);
+    uint64_t word = 0;
+    for (size_t i = 0; i < utils::bits::words_for(width); ++i) {
+        word = unpacker.unpack_u64();
+        view.signer_count_ += std::popcount(word);
+    }
+    if (width % 64 != 0 && (word >> (width % 64)) != 0) throw std::runtime_error("Votes: signer past width");
+
+    uint8_t mode;
+    unpacker.unpack_bytes(&mode, 1);
+    if (mode == static_cast<uint8_t>(Votes::Mode::INDIVIDUAL)) {
+        view.signature_count_ = view.signer_count_;
+    } else if (mode == static_cast<uint8_t>(Votes::Mode::AGGREGATE)) {
+        view.signature_count_ = 1;
+    } else {
+        throw std::runtime_error("Votes: unknown mode");
+    }
+    view.vote_mode_ = static_cast<Votes::Mode>(mode);
+    if (view.signature_count_ > unpacker.remaining() / sizeof(crypto::Signature)) throw std::runtime_error("Unpacker: truncated input");
+    unpacker.skip(view.signature_count_ * sizeof(crypto::Signature));
+    view.votes_ = unpacker.consumed_since(start);
+    return view;
+}
+
+crypto::Signature CertificateView::signature(size_t i) const {
+    crypto::Signature signature;
+    const size_t offset = votes_.size() - (signature_count_ - i) * sizeof(crypto::Signature);
+    std::memcpy(signature.data(), votes_.data() + offset, signature.size());
+    return signature;
+}
+
+Certificate CertificateView::materialize() const {
+    utils::Unpacker unpacker(votes_);
+    return Certificate(header_.materialize(), Votes::deserialize(unpacker), digest());
+}
+
+// --- InboundFilter ---
+
+InboundFilter::InboundFilter(config::Committee committee, Round window)
+    : committee_(std::move(committee)), window_(window),
+      words_(utils::bits::words_for(committee_.size())) {
+    // One row per round from the floor to the top of the window.
+    const size_t rows = std::bit_ceil(static_cast<size_t>(window_) + 1);
+    rounds_.assign(rows, 0);
+    seen_.assign(rows * words_, 0);
+}
+
+std::span<uint64_t> InboundFilter::seen(Round round) {
+    const size_t row = round & (rounds_.size() - 1);
+    if (rounds_[row] != round) return {};
+    return {seen_.data() + row * words_, words_};
+}
+
+bool InboundFilter::accept(const CertificateView& certificate) {
+    auto index = committee_.index_of(certificate.origin());
+    if (!index) return false;
+    const Round round = certificate.round();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!in_window(round)) return false;
+    auto verified = seen(round);
+    return verified.empty() || !utils::bits::test(verified, *index);
+}
+
+bool InboundFilter::record(const Certificate& certificate) {
+    auto index = committee_.index_of(certificate.origin());
+    if (!index) return false;
+    const Round round = certificate.round();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!in_window(round)) return false;
+    auto verified = seen(round);
+    if (verified.empty()) {
+        // Within the window every round has its own row, so the one found
+        // here is below the floor.
+        const size_t row = round & (rounds_.size() - 1);
+        rounds_[row] = round;
+        verified = {seen_.data() + row * words_, words_};
+        std::fill(verified.begin(), verified.end(), 0);
+    }
+    if (utils::bits::test(verified, *index)) return false;
+    utils::bits::set(verified, *index);
+    return true;
+}
+
+void InboundFilter::advance(Round round) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    floor_ = std::max(floor_, round);
+}
+
+} // namespace narwhal::consensus
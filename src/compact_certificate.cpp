@@ -0,0 +1,159 @@
+#include "narwhal/compact_certificate.hpp"
+#include "narwhal/certificate_view.hpp"
+#include <bit>
+
+namespace narwhal::consensus {
+
+namespace {
+// Author and round open both encodings.
+constexpr size_t PREFIX = sizeof(crypto::PublicKey) + 8;
+} // namespace
+
+// --- SlotTable ---
+
+SlotTable::SlotTable(config::Committee committee, Round depth) : committee_(std::move(committee)) {
+    const size_t rows = std::bit_ceil(static_cast<size_t>(std::max<Round>(depth, 1)));
+    rounds_.assign(rows, 0);
+    present_.assign(rows * utils::bits::words_for(width()), 0);
+    digests_.resize(rows * width());
+}
+
+bool SlotTable::insert(const Certificate& certificate) {
+    auto slot = committee_.index_of(certificate.origin());
+    return slot && insert(certificate.round(), *slot, certificate.digest());
+}
+
+bool SlotTable::insert(Round round, Index slot, const crypto::Digest& digest) {
+    if (slot >= width()) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = round & (rounds_.size() - 1);
+    const size_t words = utils::bits::words_for(width());
+    std::span<uint64_t> present(present_.data() + index * words, words);
+    if (rounds_[index] != round) {
+        // A later round already reuses this row.
+        if (rounds_[index] > round) return false;
+        rounds_[index] = round;
+        std::fill(present.begin(), present.end(), 0);
+    }
+    if (utils::bits::test(present, slot)) return false;
+    utils::bits::set(present, slot);
+    digests_[index * width() + slot] = digest;
+    return true;
+}
+
+std::optional<crypto::Digest> SlotTable::get(Round round, Index slot) const {
+    if (slot >= width()) return std::nullopt;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = round & (rounds_.size() - 1);
+    const size_t words = utils::bits::words_for(width());
+    if (rounds_[index] != round || !utils::bits::test({present_.data() + index * words, words}, slot)) return std::nullopt;
+    return digests_[index * width() + slot];
+}
+
+std::optional<SlotTable::Index> SlotTable::find(Round round, const crypto::Digest& digest, Index from) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = round & (rounds_.size() - 1);
+    if (rounds_[index] != round) return std::nullopt;
+    const size_t words = utils::bits::words_for(width());
+    std::span<const uint64_t> present(present_.data() + index * words, words);
+    for (Index slot = from; slot < width(); ++slot) {
+        if (utils::bits::test(present, slot) && digests_[index * width() + slot] == digest) return slot;
+    }
+    return std::nullopt;
+}
+
+// --- CompactCertificate ---
+
+CompactCertificate::CompactCertificate(const Certificate& certificate, const SlotTable& slots)
+    : certificate_(certificate), parents_(slots.width()) {
+    const Header& header = certificate.header();
+    if (header.round == 0) return;
+    // Parents are matched against the slots in order, so the bitmap stays
+    // in step with the prefix of the list it replaces.
+    SlotTable::Index next = 0;
+    for (const auto& parent : header.parents) {
+        auto slot = slots.find(header.round - 1, parent, next);
+        if (!slot) break;
+        parents_.set(*slot);
+        next = *slot + 1;
+        ++compressed_;
+    }
+}
+
+size_t CompactCertificate::serialized_size() const {
+    const Header& header = certificate_.header();
+    const size_t exceptions = header.parents.size() - compressed_;
+    const size_t full_parents = 8 + header.parents.size() * sizeof(crypto::Digest);
+    return certificate_.serialized_size() - full_parents + sizeof(crypto::Digest) +
+           8 + parents_.words().size() * 8 + 8 + exceptions * sizeof(crypto::Digest);
+}
+
+void CompactCertificate::serialize_into(std::span<uint8_t> out) const {
+    const Header& header = certificate_.header();
+    utils::Writer writer(out);
+    writer.write_bytes(header.author.data(), header.author.size());
+    writer.write_u64(header.round);
+    const auto& digest = certificate_.digest();
+    writer.write_bytes(digest.data(), digest.size());
+    writer.write_u64(parents_.size());
+    for (uint64_t word : parents_.words()) writer.write_u64(word);
+    writer.write_u64(header.parents.size() - compressed_);
+    writer.write_bytes(reinterpret_cast<const uint8_t*>(header.parents.data() + compressed_),
+                       (header.parents.size() - compressed_) * sizeof(crypto::Digest));
+    header.serialize_payload_into(writer);
+    certificate_.votes.serialize_into(out.subspan(writer.position()));
+}
+
+// --- Expansion ---
+
+bool expand_compact(std::span<const uint8_t> compact, const SlotTable& slots, std::vector<uint8_t>& out) {
+    utils::Unpacker unpacker(compact);
+    unpacker.skip(sizeof(crypto::PublicKey));
+    const Round round = unpacker.unpack_u64();
+    const auto digest = unpacker.unpack_array<std::tuple_size_v<crypto::Digest>>();
+    if (unpacker.unpack_u64() != slots.width()) throw std::runtime_error("CompactCertificate: slot width mismatch");
+
+    utils::Bitmap parents(slots.width());
+    for (auto& word : parents.words()) word = unpacker.unpack_u64();
+    if (slots.width() % 64 != 0 && (parents.words().back() >> (slots.width() % 64)) != 0) {
+        throw std::runtime_error("CompactCertificate: slot past width");
+    }
+    if (round == 0 && parents.any()) throw std::runtime_error("CompactCertificate: parents before round 0");
+    const size_t exceptions = unpacker.unpack_count(sizeof(crypto::Digest));
+    const size_t exceptions_at = unpacker.position();
+    unpacker.skip(exceptions * sizeof(crypto::Digest));
+    // Payload and votes are encoded identically in both forms.
+    auto tail = compact.subspan(unpacker.position());
+
+    const size_t resolved = parents.count();
+    out.resize(PREFIX + 8 + (resolved + exceptions) * sizeof(crypto::Digest) + tail.size());
+    utils::Writer writer(out);
+    writer.write_bytes(compact.data(), PREFIX);
+    writer.write_u64(resolved + exceptions);
+    bool complete = true;
+    parents.for_each([&](size_t slot) {
+        if (!complete) return;
+        auto parent = slots.get(round - 1, static_cast<SlotTable::Index>(slot));
+        if (!parent) {
+            complete = false;
+            return;
+        }
+        writer.write_bytes(parent->data(), parent->size());
+    });
+    if (!complete) return false;
+    writer.write_bytes(compact.data() + exceptions_at, exceptions * sizeof(crypto::Digest));
+    writer.write_bytes(tail.data(), tail.size());
+
+    // A slot that holds another certificate here than at the sender gives
+    // another header.
+    utils::Unpacker expanded(out);
+    return HeaderView::parse(expanded).digest() == digest;
+}
+
+std::pair<crypto::PublicKey, Round> compact_origin(std::span<const uint8_t> compact) {
+    utils::Unpacker unpacker(compact);
+    auto author = unpacker.unpack_array<std::tuple_size_v<crypto::PublicKey>>();
+    return {author, unpacker.unpack_u64()};
+}
+
+} // namespace narwhal::consensus
@@ -1,375 +1,608 @@
 #include "narwhal/consensus.hpp"
+#include "narwhal/certificate_view.hpp"
 #include <algorithm>
+#include <limits>
+#include <numeric>
 #include <iostream>
-#include <unordered_set>
 
 namespace narwhal::consensus {
 
 // --- Serializable Implementations ---
 
-std::vector<uint8_t> Header::serialize() const {
-    std::vector<uint8_t> buf;
-    utils::Packer::pack_bytes(buf, author.data(), author.size());
-    utils::Packer::pack_u64(buf, round);
-    utils::Packer::pack_u64(buf, parents.size());
-    for (const auto& p : parents) {
-        utils::Packer::pack_bytes(buf, p.data(), p.size());
-    }
-    utils::Packer::pack_u64(buf, payload.size());
-    for (const auto& p : payload) {
-        utils::Packer::pack_bytes(buf, p.first.data(), p.first.size());
-        utils::Packer::pack_u64(buf, p.second);
-    }
-    return buf;
+size_t Header::serialized_size() const {
+    return sizeof(crypto::PublicKey) + 8 + 8 + parents.size() * sizeof(crypto::Digest) +
+           8 + payload.size() * (sizeof(crypto::Digest) + 8);
 }
 
-std::vector<uint8_t> Certificate::serialize() const {
-    std::vector<uint8_t> buf = header.serialize();
-    utils::Packer::pack_u64(buf, votes.size());
-    for (const auto& v : votes) {
-        utils::Packer::pack_bytes(buf, v.first.data(), v.first.size());
-        utils::Packer::pack_bytes(buf, v.second.data(), v.second.size());
+void Header::serialize_into(std::span<uint8_t> out) const {
+    utils::Writer writer(out);
+    writer.write_bytes(author.data(), author.size());
+    writer.write_u64(round);
+    writer.write_u64(parents.size());
+    // Digests are plain byte arrays, so the parent list is one contiguous block.
+    writer.write_bytes(reinterpret_cast<const uint8_t*>(parents.data()), parents.size() * sizeof(crypto::Digest));
+    serialize_payload_into(writer);
+}
+
+void Header::serialize_payload_into(utils::Writer& writer) const {
+    writer.write_u64(payload.size());
+    for (const auto& entry : payload) {
+        writer.write_bytes(entry.digest.data(), entry.digest.size());
+        writer.write_u64(entry.worker);
     }
-    return buf;
 }
 
-crypto::Digest Certificate::digest() const {
-    return crypto::Hash::compute(header.serialize());
+Header Header::deserialize(utils::Unpacker& unpacker) {
+    Header header;
+    header.author = unpacker.unpack_array<std::tuple_size_v<crypto::PublicKey>>();
+    header.round = unpacker.unpack_u64();
+    header.parents.resize(unpacker.unpack_count(sizeof(crypto::Digest)));
+    for (auto& parent : header.parents) parent = unpacker.unpack_array<std::tuple_size_v<crypto::Digest>>();
+    std::vector<Payload::Entry> entries(unpacker.unpack_count(sizeof(crypto::Digest) + 8));
+    for (auto& entry : entries) {
+        entry.digest = unpacker.unpack_array<std::tuple_size_v<crypto::Digest>>();
+        uint64_t worker = unpacker.unpack_u64();
+        if (worker > std::numeric_limits<WorkerId>::max()) throw std::runtime_error("Header: worker id out of range");
+        entry.worker = static_cast<WorkerId>(worker);
+    }
+    if (!Payload::is_canonical(entries)) throw std::runtime_error("Header: payload not in canonical order");
+    header.payload = Payload::from_sorted(std::move(entries));
+    return header;
 }
 
-// --- State Implementation ---
+bool Votes::add(Index signer, const crypto::Signature& signature) {
+    if (mode_ != Mode::INDIVIDUAL || signed_by(signer) || signer >= width()) return false;
+    // Signatures are kept in signer order: this one goes after every signer below it.
+    auto words = signers_.words();
+    size_t rank = 0;
+    for (size_t i = 0; i < signer / 64; ++i) rank += std::popcount(words[i]);
+    rank += std::popcount(words[signer / 64] & ((uint64_t{1} << (signer % 64)) - 1));
+    signers_.set(signer);
+    signatures_.insert(signatures_.begin() + rank, signature);
+    return true;
+}
 
-State::State(const std::vector<Certificate>& genesis_certs) {
-    last_committed_round = 0;
-    std::unordered_map<crypto::PublicKey, std::pair<crypto::Digest, Certificate>> genesis_map;
-    
-    for (const auto& cert : genesis_certs) {
-        crypto::PublicKey origin = cert.origin();
-        genesis_map[origin] = {cert.digest(), cert};
-        last_committed[origin] = cert.round();
-    }
-    
-    dag[0] = std::move(genesis_map);
+Votes Votes::aggregate(const crypto::AggregateScheme& scheme) const {
+    if (mode_ == Mode::AGGREGATE) return *this;
+    Votes aggregated;
+    aggregated.mode_ = Mode::AGGREGATE;
+    aggregated.signers_ = signers_;
+    aggregated.signatures_.push_back(scheme.aggregate(signatures_));
+    return aggregated;
 }
 
-void State::update(const Certificate& certificate, Round gc_depth) {
-    crypto::PublicKey origin = certificate.origin();
-    last_committed[origin] = std::max(last_committed[origin], certificate.round());
+size_t Votes::serialized_size() const {
+    return 8 + signers_.words().size() * 8 + 1 + signatures_.size() * sizeof(crypto::Signature);
+}
 
-    Round max_round = 0;
-    for (const auto& p : last_committed) {
-        max_round = std::max(max_round, p.second);
-    }
-    last_committed_round = max_round;
+void Votes::serialize_into(std::span<uint8_t> out) const {
+    utils::Writer writer(out);
+    writer.write_u64(width());
+    for (uint64_t word : signers_.words()) writer.write_u64(word);
+    const auto mode = static_cast<uint8_t>(mode_);
+    writer.write_bytes(&mode, 1);
+    // Signatures are plain byte arrays, so the list is one contiguous block.
+    writer.write_bytes(reinterpret_cast<const uint8_t*>(signatures_.data()), signatures_.size() * sizeof(crypto::Signature));
+}
 
-    for (auto it = dag.begin(); it != dag.end(); ) {
-        if (it->first + gc_depth < last_committed_round) {
-            it = dag.erase(it);
-        } else {
-            ++it;
-        }
+Votes Votes::deserialize(utils::Unpacker& unpacker) {
+    const uint64_t width = unpacker.unpack_u64();
+    if (width > unpacker.remaining() * 8) throw std::runtime_error("Votes: width exceeds input");
+    Votes votes(static_cast<size_t>(width));
+    auto words = votes.signers_.words();
+    for (auto& word : words) word = unpacker.unpack_u64();
+    if (width % 64 != 0 && (words.back() >> (width % 64)) != 0) throw std::runtime_error("Votes: signer past width");
+
+    uint8_t mode;
+    unpacker.unpack_bytes(&mode, 1);
+    size_t signatures;
+    if (mode == static_cast<uint8_t>(Mode::INDIVIDUAL)) {
+        signatures = votes.signers_.count();
+    } else if (mode == static_cast<uint8_t>(Mode::AGGREGATE)) {
+        signatures = 1;
+    } else {
+        throw std::runtime_error("Votes: unknown mode");
     }
+    votes.mode_ = static_cast<Mode>(mode);
+    if (signatures > unpacker.remaining() / sizeof(crypto::Signature)) throw std::runtime_error("Unpacker: truncated input");
+    votes.signatures_.resize(signatures);
+    for (auto& signature : votes.signatures_) signature = unpacker.unpack_array<std::tuple_size_v<crypto::Signature>>();
+    return votes;
 }
 
-// --- Consensus Implementation ---
+Certificate::Certificate(Header header, Votes votes)
+    : votes(std::move(votes)), header_(std::move(header)) {
+    // Headers are hashed into a per-thread scratch buffer that only ever grows.
+    thread_local std::vector<uint8_t> scratch;
+    const size_t size = header_.serialized_size();
+    if (scratch.size() < size) scratch.resize(size);
+    std::span<uint8_t> encoded(scratch.data(), size);
+    header_.serialize_into(encoded);
+    digest_ = crypto::Hash::compute(encoded);
+}
 
-Consensus::Consensus(config::Committee committee, Round gc_depth,
-                    std::shared_ptr<utils::Channel<Certificate>> rx,
-                    std::shared_ptr<utils::Channel<Certificate>> tx_p,
-                    std::shared_ptr<utils::Channel<Certificate>> tx_o,
-                    std::unique_ptr<ConsensusEngine> engine)
-    : committee(committee), gc_depth(gc_depth), rx_primary(rx), tx_primary(tx_p), tx_output(tx_o), engine(std::move(engine)) {}
+size_t Certificate::serialized_size() const {
+    return header_.serialized_size() + votes.serialized_size();
+}
 
-Consensus::~Consensus() {
-    running = false;
-    if (worker_thread.joinable()) {
-        worker_thread.join();
-    }
+void Certificate::serialize_into(std::span<uint8_t> out) const {
+    header_.serialize_into(out);
+    votes.serialize_into(out.subspan(header_.serialized_size()));
 }
 
-void Consensus::spawn() {
-    running = true;
-    worker_thread = std::thread(&Consensus::run, this);
+Certificate::Certificate(Header header, Votes votes, const crypto::Digest& digest)
+    : votes(std::move(votes)), header_(std::move(header)), digest_(digest) {}
+
+Certificate Certificate::deserialize(std::span<const uint8_t> data) {
+    return CertificateView::parse(data).materialize();
 }
 
-void Consensus::run() {
-    State state(Consensus::genesis(committee));
+Certificate Certificate::deserialize(utils::Unpacker& unpacker) {
+    return CertificateView::parse(unpacker).materialize();
+}
 
-    while (running) {
-        auto cert_opt = rx_primary->receive();
-        if (!cert_opt) break;
+// --- Dag Implementation ---
 
-        const Certificate& certificate = *cert_opt;
-        Round round = certificate.round();
+Dag::Dag(const config::Committee& committee, Round gc_depth) : committee_(committee), limit_(gc_depth + LOOKAHEAD) {
+    words_ = utils::bits::words_for(width());
+    capacity_ = 1;
+    while (capacity_ < gc_depth + 2) capacity_ <<= 1;
+    vertices_.resize(capacity_ * width());
+    parent_bits_.resize(capacity_ * width() * words_);
+}
 
-        state.dag[round][certificate.origin()] = {certificate.digest(), certificate};
+std::optional<Dag::Slot> Dag::slot_of(const crypto::PublicKey& author) const {
+    auto index = committee_.index_of(author);
+    if (!index) return std::nullopt;
+    return *index;
+}
 
-        std::vector<Certificate> sequence = engine->process_round(round, state.dag, state, committee);
+Dag::InsertResult Dag::insert(const CertificateRef& certificate) {
+    InsertResult result;
+    const Round round = certificate->round();
+    auto slot = slot_of(certificate->origin());
+    if (!slot || round < base_ || round - base_ > limit_) return result;
+    if (!in_window(round)) grow(round);
+
+    auto& vertex = vertices_[row(round) + *slot];
+    if (vertex) return result;
+    vertex = Vertex{certificate->digest(), certificate, *slot};
+    index_.try_emplace(certificate->digest(), Position{round, *slot});
+    highest_round_ = std::max(highest_round_, round);
+    result.inserted = true;
+
+    if (round > 0) {
+        for (const auto& parent : certificate->header().parents) {
+            auto position = locate(parent);
+            if (position && position->round + 1 == round) {
+                link({round, *slot}, position->slot, result);
+            } else if (!position && round - 1 >= base_) {
+                pending_[parent].push_back({round, *slot});
+                vertex->missing_parents++;
+            }
+        }
+    }
 
-        for (const auto& cert : sequence) {
-            tx_primary->send(cert);
-            tx_output->send(cert);
-            state.update(cert, gc_depth);
+    auto waiting = pending_.find(certificate->digest());
+    if (waiting != pending_.end()) {
+        for (const auto& child : waiting->second) {
+            if (child.round == round + 1 && get(child.round, child.slot)) {
+                vertices_[row(child.round) + child.slot]->missing_parents--;
+                link(child, *slot, result);
+            }
         }
+        pending_.erase(waiting);
     }
+    return result;
 }
 
-std::vector<Certificate> Consensus::genesis(const config::Committee& committee) {
-    std::vector<Certificate> certs;
-    for (const auto& p : committee.authorities) {
-        Certificate cert;
-        cert.header.author = p.first;
-        cert.header.round = 0;
-        certs.push_back(cert);
+void Dag::link(Position child, Slot parent, InsertResult& result) {
+    auto bits = parent_bits(child.round, child.slot);
+    if (utils::bits::test(bits, parent)) return;
+    utils::bits::set(bits, parent);
+
+    auto& vertex = *vertices_[row(child.round - 1) + parent];
+    Stake before = vertex.support;
+    vertex.support += committee_.stake(child.slot);
+    if (before < committee_.validity_threshold() && vertex.support >= committee_.validity_threshold()) {
+        result.supported.push_back({child.round - 1, parent});
     }
-    return certs;
 }
 
-// --- Tusk Engine Implementation ---
+const Vertex* Dag::get(Round round, Slot slot) const {
+    if (!in_window(round) || slot >= width()) return nullptr;
+    const auto& vertex = vertices_[row(round) + slot];
+    return vertex ? &*vertex : nullptr;
+}
 
-std::vector<Certificate> TuskEngine::process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) {
-    if (round < 4 || (round - 1) % 2 != 0) return {};
+const Vertex* Dag::get(Round round, const crypto::PublicKey& author) const {
+    auto slot = slot_of(author);
+    return slot ? get(round, *slot) : nullptr;
+}
 
-    Round r = round - 1;
-    Round leader_round = r - 2;
+const Vertex* Dag::get(const crypto::Digest& digest) const {
+    auto position = locate(digest);
+    return position ? get(position->round, position->slot) : nullptr;
+}
 
-    if (leader_round <= state.last_committed_round) return {};
+std::optional<Dag::Position> Dag::locate(const crypto::Digest& digest) const {
+    auto it = index_.find(digest);
+    if (it == index_.end()) return std::nullopt;
+    return it->second;
+}
 
-    auto leader_opt = leader(leader_round, dag, committee);
-    if (!leader_opt) return {};
-
-    const auto& leader_digest = leader_opt->first;
-    const auto& leader_cert = leader_opt->second;
-
-    Stake stake = 0;
-    auto rit = dag.find(r - 1);
-    if (rit != dag.end()) {
-        for (const auto& p : rit->second) {
-            const auto& cert = p.second.second;
-            for (const auto& parent : cert.header.parents) {
-                if (parent == leader_digest) {
-                    stake += committee.get_stake(cert.origin());
-                    break;
-                }
-            }
-        }
-    }
+std::span<const std::optional<Vertex>> Dag::round(Round round) const {
+    if (!in_window(round)) return {};
+    return {vertices_.data() + row(round), width()};
+}
 
-    if (stake < committee.validity_threshold()) return {};
+std::span<const uint64_t> Dag::parents(Round round, Slot slot) const {
+    if (!in_window(round) || slot >= width()) return {};
+    return {parent_bits_.data() + (row(round) + slot) * words_, words_};
+}
 
-    auto leaders = order_leaders(leader_cert, state, dag, committee);
-    std::reverse(leaders.begin(), leaders.end());
+utils::Bitmap Dag::reachable(Position from, Round target) const {
+    utils::Bitmap frontier(width());
+    if (target > from.round || target < base_ || !get(from.round, from.slot)) return frontier;
+    frontier.set(from.slot);
+
+    utils::Bitmap next(width());
+    for (Round r = from.round; r > target; --r) {
+        next.clear();
+        frontier.for_each([&](Slot slot) { next |= parents(r, slot); });
+        std::swap(frontier, next);
+        if (!frontier.any()) break;
+    }
+    return frontier;
+}
 
-    std::vector<Certificate> sequence;
-    for (const auto& l : leaders) {
-        for (const auto& x : order_dag(l, state)) {
-            sequence.push_back(x);
+bool Dag::linked(Position from, Position to) const {
+    return reachable(from, to.round).test(to.slot);
+}
+
+void Dag::advance(Round new_base, std::vector<CertificateRef>& released) {
+    if (new_base <= base_) return;
+    Round end = std::min<Round>(new_base, base_ + capacity_);
+    for (Round r = base_; r < end; ++r) {
+        for (Slot slot = 0; slot < width(); ++slot) {
+            auto& vertex = vertices_[row(r) + slot];
+            if (!vertex) continue;
+            auto it = index_.find(vertex->digest);
+            if (it != index_.end() && it->second.round == r && it->second.slot == slot) index_.erase(it);
+            released.push_back(std::move(vertex->certificate));
+            vertex.reset();
         }
+        std::fill_n(parent_bits_.begin() + row(r) * words_, width() * words_, 0);
+    }
+    base_ = new_base;
+
+    // Children below the window can no longer be patched.
+    for (auto it = pending_.begin(); it != pending_.end(); ) {
+        auto& children = it->second;
+        std::erase_if(children, [&](const Position& child) { return child.round < base_; });
+        it = children.empty() ? pending_.erase(it) : std::next(it);
     }
-    return sequence;
 }
 
-std::optional<std::pair<crypto::Digest, Certificate>> TuskEngine::leader(Round round, const dag_t& dag, const config::Committee& committee) {
-    auto it = dag.find(round);
-    if (it == dag.end() || it->second.empty()) return std::nullopt;
+void Dag::grow(Round round) {
+    size_t capacity = capacity_;
+    while (round - base_ >= capacity) capacity <<= 1;
 
-    std::vector<crypto::PublicKey> keys;
-    for (const auto& p : it->second) keys.push_back(p.first);
-    std::sort(keys.begin(), keys.end());
+    std::vector<std::optional<Vertex>> vertices(capacity * width());
+    std::vector<uint64_t> parent_bits(capacity * width() * words_);
+    for (Round r = base_; r < base_ + capacity_; ++r) {
+        size_t to = (r & (capacity - 1)) * width();
+        std::move(vertices_.begin() + row(r), vertices_.begin() + row(r) + width(), vertices.begin() + to);
+        std::copy_n(parent_bits_.begin() + row(r) * words_, width() * words_, parent_bits.begin() + to * words_);
+    }
+    vertices_ = std::move(vertices);
+    parent_bits_ = std::move(parent_bits);
+    capacity_ = capacity;
+}
+
+// --- State Implementation ---
 
-    crypto::PublicKey leader_key = keys[round % keys.size()];
-    auto cert_it = it->second.find(leader_key);
-    if (cert_it != it->second.end()) return cert_it->second;
-    return std::nullopt;
+State::State(const config::Committee& committee, Round gc_depth, const std::vector<CertificateRef>& genesis_certs)
+    : last_committed_round(0), last_committed(committee.size(), 0), gc_depth(gc_depth), dag(committee, gc_depth) {
+    for (const auto& cert : genesis_certs) {
+        dag.insert(cert);
+    }
 }
 
-std::vector<Certificate> TuskEngine::order_leaders(const Certificate& leader_cert, const State& state, const dag_t& dag, const config::Committee& committee) {
-    std::vector<Certificate> to_commit = {leader_cert};
-    const Certificate* current = &leader_cert;
+std::vector<CertificateRef> State::update(std::span<const CertificateRef> sequence) {
+    // Per-authority rounds only grow, so the overall maximum is a running max.
+    for (const auto& certificate : sequence) {
+        auto slot = dag.slot_of(certificate->origin());
+        if (slot) last_committed[*slot] = std::max(last_committed[*slot], certificate->round());
+        last_committed_round = std::max(last_committed_round, certificate->round());
+    }
 
-    for (Round r = current->round() - 2; r > state.last_committed_round; r -= 2) {
-        auto prev = leader(r, dag, committee);
-        if (!prev) continue;
-        if (linked(*current, prev->second, dag)) {
-            to_commit.push_back(prev->second);
-            current = &to_commit.back();
-        }
-        if (r < 2) break;
+    std::vector<CertificateRef> released;
+    if (last_committed_round > gc_depth) {
+        dag.advance(last_committed_round - gc_depth, released);
     }
-    return to_commit;
+    return released;
 }
 
-bool TuskEngine::linked(const Certificate& leader, const Certificate& prev_leader, const dag_t& dag) {
-    std::vector<const Certificate*> current_round = {&leader};
-    for (Round r = leader.round(); r > prev_leader.round(); --r) {
-        auto it = dag.find(r - 1);
-        if (it == dag.end()) return false;
-        std::vector<const Certificate*> next_parents;
-        for (const auto& p : it->second) {
-            for (const auto* curr : current_round) {
-                bool found = false;
-                for (const auto& parent_digest : curr->header.parents) {
-                    if (parent_digest == p.second.first) { found = true; break; }
-                }
-                if (found) {
-                    next_parents.push_back(&p.second.second);
-                    break;
-                }
-            }
-        }
-        current_round = std::move(next_parents);
-        if (current_round.empty()) return false;
+// --- LeaderSchedule Implementation ---
+
+LeaderSchedule::LeaderSchedule(const config::Committee& committee, size_t leaders_per_round)
+    : LeaderSchedule([&] {
+          std::vector<Dag::Slot> order(committee.size());
+          std::iota(order.begin(), order.end(), Dag::Slot{0});
+          return order;
+      }(), leaders_per_round) {}
+
+LeaderSchedule::LeaderSchedule(std::vector<Dag::Slot> order, size_t leaders_per_round, Round start)
+    : order_(std::move(order)),
+      per_round_(std::clamp<size_t>(leaders_per_round, 1, std::max<size_t>(order_.size(), 1))),
+      start_(start) {}
+
+std::shared_ptr<const LeaderSchedule> ConsensusEngine::schedule_for(const config::Committee& committee, size_t leaders_per_round) {
+    auto schedule = leader_schedule();
+    if (!schedule) {
+        schedule = std::make_shared<const LeaderSchedule>(committee, leaders_per_round);
+        publish(schedule);
     }
-    for (const auto* c : current_round) if (c->digest() == prev_leader.digest()) return true;
-    return false;
+    return schedule;
 }
 
-std::vector<Certificate> TuskEngine::order_dag(const Certificate& leader, const State& state) {
-    std::vector<Certificate> ordered;
-    std::unordered_set<std::string> seen;
-    std::vector<const Certificate*> buffer = {&leader};
+// --- Linearizer Implementation ---
+
+Linearizer::Linearizer(const State& state) : state(state), committed(state.last_committed) {}
+
+void Linearizer::order(const Vertex& leader, std::vector<CertificateRef>& sequence) {
+    const Dag& dag = state.dag;
+    const Round leader_round = leader.certificate->round();
+    if (leader_round < dag.base()) return;
+
+    const Round base = dag.base();
+    const size_t width = dag.width();
+    marks.resize(std::max(marks.size(), (leader_round - base + 1) * width), 0);
+    const uint32_t id = ++leaders;
+
+    uint32_t& leader_mark = mark(leader_round, leader.slot);
+    if (leader_mark != 0) return;
+    leader_mark = id;
 
+    Round lowest = leader_round;
+    std::vector<Dag::Position> buffer = {{leader_round, leader.slot}};
     while (!buffer.empty()) {
-        const Certificate* x = buffer.back();
+        Dag::Position x = buffer.back();
         buffer.pop_back();
-        ordered.push_back(*x);
-        if (x->round() == 0) continue;
-        auto it = state.dag.find(x->round() - 1);
-        if (it == state.dag.end()) continue;
-        for (const auto& p_digest : x->header.parents) {
-            for (const auto& p : it->second) {
-                if (p.second.first == p_digest) {
-                    std::string hex = crypto::Hash::to_hex(p_digest);
-                    bool skip = seen.count(hex) || (state.last_committed.count(p.second.second.origin()) && state.last_committed.at(p.second.second.origin()) == p.second.second.round());
-                    if (!skip) {
-                        buffer.push_back(&p.second.second);
-                        seen.insert(hex);
-                    }
-                    break;
-                }
+        if (x.round == base) continue;
+        utils::bits::for_each(dag.parents(x.round, x.slot), [&](Dag::Slot slot) {
+            uint32_t& m = mark(x.round - 1, slot);
+            if (m != 0) return;
+            if (committed[slot] >= x.round - 1) {
+                m = SKIPPED;
+                return;
             }
+            m = id;
+            lowest = std::min(lowest, x.round - 1);
+            buffer.push_back({x.round - 1, slot});
+        });
+    }
+
+    // Sweeping the marks round by round emits the sub-DAG in (round, slot) order.
+    for (Round r = lowest; r <= leader_round; ++r) {
+        auto vertices = dag.round(r);
+        for (Dag::Slot slot = 0; slot < width; ++slot) {
+            if (mark(r, slot) != id) continue;
+            sequence.push_back(vertices[slot]->certificate);
+            committed[slot] = std::max(committed[slot], r);
         }
     }
-    std::sort(ordered.begin(), ordered.end(), [](const Certificate& a, const Certificate& b) { return a.round() < b.round(); });
-    return ordered;
 }
 
-// --- Shoal++ Engine Implementation ---
+// --- Consensus Implementation ---
 
-std::vector<Certificate> ShoalPlusPlusEngine::process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) {
-    Round leader_round = round - 1; 
-    if (leader_round <= state.last_committed_round) return {};
+Consensus::Consensus(config::Committee committee, Round gc_depth,
+                    std::shared_ptr<utils::Channel<CertificateRef>> rx,
+                    std::shared_ptr<utils::Channel<CertificateRef>> tx_p,
+                    std::shared_ptr<utils::Channel<CertificateRef>> tx_o,
+                    std::unique_ptr<ConsensusEngine> engine,
+                    config::Parameters parameters)
+    : committee(committee), gc_depth(gc_depth), parameters(parameters), rx_primary(rx), tx_primary(tx_p), tx_output(tx_o), engine(std::move(engine)) {
+    if (!parameters.record_path.empty()) recorder = std::make_unique<Recorder>(parameters.record_path, committee);
+}
 
-    auto anchor_opt = select_anchor(leader_round, dag, committee);
-    if (!anchor_opt) return {};
-
-    const auto& anchor_digest = anchor_opt->first;
-    const auto& anchor_cert = anchor_opt->second;
-
-    Stake stake = 0;
-    auto rit = dag.find(round); 
-    if (rit != dag.end()) {
-        for (const auto& p : rit->second) {
-            for (const auto& parent : p.second.second.header.parents) {
-                if (parent == anchor_digest) {
-                    stake += committee.get_stake(p.second.second.origin());
-                    break;
-                }
-            }
-        }
+Consensus::~Consensus() {
+    // The outboxes resume the consumer, so they let go of it first.
+    if (to_primary) to_primary->detach();
+    if (to_output) to_output->detach();
+    consumer.reset();
+    running = false;
+    if (worker_thread.joinable()) {
+        worker_thread.join();
     }
+}
 
-    if (stake < committee.validity_threshold()) return {};
+void Consensus::spawn() {
+    running = true;
+    worker_thread = std::thread([this] {
+        utils::place_current_thread(parameters.placement);
+        run();
+    });
+}
 
-    std::vector<Certificate> sequence;
-    sequence.push_back(anchor_cert);
-    
-    update_reputation(sequence);
-    return sequence;
+void Consensus::join() {
+    if (worker_thread.joinable()) worker_thread.join();
 }
 
-std::optional<std::pair<crypto::Digest, Certificate>> ShoalPlusPlusEngine::select_anchor(Round round, const dag_t& dag, const config::Committee& committee) {
-    auto it = dag.find(round);
-    if (it == dag.end() || it->second.empty()) return std::nullopt;
-
-    std::vector<crypto::PublicKey> candidates;
-    for (const auto& p : it->second) candidates.push_back(p.first);
-    std::sort(candidates.begin(), candidates.end());
-
-    uint64_t total_reputation = 0;
-    for (const auto& pk : candidates) total_reputation += reputation[pk] + 1;
-    
-    uint64_t choice = round % total_reputation;
-    uint64_t current = 0;
-    for (const auto& pk : candidates) {
-        current += reputation[pk] + 1;
-        if (current > choice) {
-            auto cert_it = it->second.find(pk);
-            return cert_it->second;
-        }
+void Consensus::spawn(utils::Executor& executor) {
+    prepare();
+    retire = [&executor](std::vector<CertificateRef> released) {
+        executor.post([released = std::move(released)] {});
+    };
+    to_primary = std::make_unique<utils::Outbox<CertificateRef>>(tx_primary, [this] { consumer->resume(); });
+    to_output = std::make_unique<utils::Outbox<CertificateRef>>(tx_output, [this] { consumer->resume(); });
+    // The engine is single-threaded: it runs on a strand, scheduled whenever
+    // rx_primary has certificates. A batch is whatever is queued at that
+    // point. No new batch is taken while commits are held back, so a full
+    // output still holds back rx_primary.
+    consumer = std::make_unique<utils::Consumer<CertificateRef>>(
+        std::make_shared<utils::Strand>(executor), rx_primary, [this] {
+            size_t count;
+            while (flushed() && (count = rx_primary->try_receive_batch(batch)) != 0) process(count);
+        }, true);
+    consumer->resume();
+}
+
+void Consensus::run() {
+    prepare();
+    utils::Reclaimer<std::vector<CertificateRef>> reclaimer;
+    retire = [&reclaimer](std::vector<CertificateRef> released) { reclaimer.retire(std::move(released)); };
+
+    while (running) {
+        size_t count = receive_batch(batch);
+        if (count == 0) break;
+        process(count);
     }
+    retire = nullptr;
+}
 
-    return std::nullopt;
+void Consensus::prepare() {
+    state = std::make_unique<State>(committee, gc_depth, Consensus::genesis(committee));
+    batch.resize(std::max<size_t>(parameters.max_batch_size, 1));
 }
 
-void ShoalPlusPlusEngine::update_reputation(const std::vector<Certificate>& committed) {
-    for (const auto& cert : committed) {
-        reputation[cert.origin()]++;
+void Consensus::process(size_t count) {
+    // Insert everything that is available first, then run the commit rule
+    // once per affected round instead of once per certificate.
+    supported.clear();
+    rounds.clear();
+    if (recorder) {
+        auto arrival = Recorder::Clock::now();
+        for (size_t i = 0; i < count; ++i) recorder->record(batch[i], arrival);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        auto inserted = state->dag.insert(batch[i]);
+        supported.insert(supported.end(), inserted.supported.begin(), inserted.supported.end());
+        if (inserted.inserted) rounds.push_back(batch[i]->round());
+        batch[i].reset();
+    }
+
+    for (const auto& position : supported) {
+        const Vertex* vertex = state->dag.get(position.round, position.slot);
+        if (vertex) commit(engine->on_supported(*vertex, state->dag, *state, committee));
     }
-    
-    if (reputation.size() > 100) {
-        for (auto& p : reputation) p.second /= 2;
+
+    std::sort(rounds.begin(), rounds.end());
+    rounds.erase(std::unique(rounds.begin(), rounds.end()), rounds.end());
+    for (Round round : rounds) {
+        commit(engine->process_round(round, state->dag, *state, committee));
     }
 }
 
-// --- Mysticeti Engine Implementation ---
+void Consensus::commit(const std::vector<CertificateRef>& sequence) {
+    if (sequence.empty()) return;
+    if (to_primary) {
+        to_primary->send_batch(sequence);
+        to_output->send_batch(sequence);
+    } else {
+        tx_primary->send_batch(sequence);
+        tx_output->send_batch(sequence);
+    }
+    auto released = state->update(sequence);
+    if (!released.empty()) retire(std::move(released));
+}
 
-std::vector<Certificate> MysticetiEngine::process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) {
-    if (round < 3) return {};
+bool Consensus::flushed() {
+    if (to_primary->empty() && to_output->empty()) return true;
+    // Paused before flushing, so room freed in between still resumes it.
+    consumer->pause();
+    bool primary = to_primary->flush();
+    bool output = to_output->flush();
+    if (!primary || !output) return false;
+    consumer->resume();
+    return true;
+}
 
-    Round leader_round = round - 2;
-    if (leader_round <= state.last_committed_round) return {};
+size_t Consensus::receive_batch(std::span<CertificateRef> batch) {
+    size_t count = rx_primary->receive_batch(batch);
+    if (count == 0 || parameters.max_batch_delay.count() == 0) return count;
 
-    auto leader_pk_opt = get_leader(leader_round, committee);
-    if (!leader_pk_opt) return {};
-    auto leader_pk = *leader_pk_opt;
-
-    auto lit = dag.find(leader_round);
-    if (lit == dag.end() || lit->second.find(leader_pk) == lit->second.end()) return {};
-
-    const auto& leader_digest = lit->second.at(leader_pk).first;
-    const auto& leader_cert = lit->second.at(leader_pk).second;
-
-    Stake votes = 0;
-    auto rit = dag.find(leader_round + 1);
-    if (rit != dag.end()) {
-        for (const auto& p : rit->second) {
-            const auto& cert = p.second.second;
-            for (const auto& parent_digest : cert.header.parents) {
-                if (parent_digest == leader_digest) {
-                    votes += committee.get_stake(cert.origin());
-                    break;
-                }
-            }
-        }
+    auto deadline = std::chrono::steady_clock::now() + parameters.max_batch_delay;
+    while (count < batch.size()) {
+        size_t more = rx_primary->receive_batch_until(batch.subspan(count), deadline);
+        if (more == 0) break;
+        count += more;
     }
+    return count;
+}
+
+std::vector<CertificateRef> Consensus::genesis(const config::Committee& committee) {
+    std::vector<CertificateRef> certs;
+    for (const auto& [name, _] : committee.authorities()) {
+        Header header;
+        header.author = name;
+        header.round = 0;
+        certs.push_back(std::make_shared<const Certificate>(std::move(header)));
+    }
+    return certs;
+}
+
+std::unique_ptr<ConsensusEngine> make_engine(const std::string& name) {
+    if (name == "tusk") return std::make_unique<TuskEngine>();
+    if (name == "shoal++") return std::make_unique<ShoalPlusPlusEngine>();
+    if (name == "mysticeti") return std::make_unique<MysticetiEngine>();
+    return nullptr;
+}
+
+// --- Tusk Engine Implementation ---
+
+std::vector<CertificateRef> TuskEngine::process_round(Round round, Dag& dag, State& state, const config::Committee& committee) {
+    if (round < 4 || (round - 1) % 2 != 0) return {};
+
+    Round r = round - 1;
+    Round leader_round = r - 2;
+
+    if (leader_round <= state.last_committed_round) return {};
 
-    if (votes < committee.validity_threshold()) return {};
+    const Vertex* leader_vertex = leader(leader_round, dag, *schedule_for(committee));
+    if (!leader_vertex || leader_vertex->support < committee.validity_threshold()) return {};
+
+    return commit(*leader_vertex, dag, state, committee);
+}
 
-    std::cout << "[Mysticeti] Leader at round " << leader_round << " committed with " << votes << " votes." << std::endl;
-    return {leader_cert};
+std::vector<CertificateRef> TuskEngine::on_supported(const Vertex& vertex, Dag& dag, State& state, const config::Committee& committee) {
+    Round round = vertex.certificate->round();
+    if (round < 2 || round % 2 != 0 || round <= state.last_committed_round) return {};
+    if (leader(round, dag, *schedule_for(committee)) != &vertex) return {};
+    return commit(vertex, dag, state, committee);
 }
 
-std::optional<crypto::PublicKey> MysticetiEngine::get_leader(Round round, const config::Committee& committee) {
-    std::vector<crypto::PublicKey> keys;
-    for (const auto& p : committee.authorities) keys.push_back(p.first);
-    std::sort(keys.begin(), keys.end());
-    if (keys.empty()) return std::nullopt;
-    return keys[round % keys.size()];
+std::vector<CertificateRef> TuskEngine::commit(const Vertex& leader_vertex, Dag& dag, State& state, const config::Committee& committee) {
+    auto leaders = order_leaders(leader_vertex, state, dag, *schedule_for(committee));
+    std::reverse(leaders.begin(), leaders.end());
+
+    std::vector<CertificateRef> sequence;
+    Linearizer linearizer(state);
+    for (const auto* l : leaders) {
+        linearizer.order(*l, sequence);
+    }
+    return sequence;
 }
 
-bool MysticetiEngine::can_commit(Round round, const dag_t& dag, const config::Committee& committee) {
-    return true; 
+const Vertex* TuskEngine::leader(Round round, const Dag& dag, const LeaderSchedule& schedule) const {
+    return dag.get(round, schedule.leader(round));
+}
+
+std::vector<const Vertex*> TuskEngine::order_leaders(const Vertex& leader_vertex, const State& state, const Dag& dag, const LeaderSchedule& schedule) const {
+    std::vector<const Vertex*> to_commit = {&leader_vertex};
+    const Vertex* current = &leader_vertex;
+
+    for (Round r = current->certificate->round() - 2; r > state.last_committed_round; r -= 2) {
+        const Vertex* prev = leader(r, dag, schedule);
+        if (!prev) continue;
+        if (dag.linked({current->certificate->round(), current->slot}, {r, prev->slot})) {
+            to_commit.push_back(prev);
+            current = prev;
+        }
+        if (r < 2) break;
+    }
+    return to_commit;
 }
 
 } // namespace narwhal::consensus
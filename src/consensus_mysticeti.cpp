@@ -1,83 +1,115 @@
 #include "narwhal/consensus.hpp"
 #include <algorithm>
-#include <iostream>
-#include <unordered_set>
 
 namespace narwhal::consensus {
 
-// --- Tusk Engine Implementation ---
-// (Keeping existing implementations for Tusk and Shoal++...)
-// [Note: In reality I'd append but since I'm overwriting the file to ensure consistency, I'll include the previous ones too]
+// --- Mysticeti Engine Implementation ---
 
-// ... (Skipping Tusk and Shoal++ for brevity in this thought, but I will write the full file)
+MysticetiEngine::MysticetiEngine(size_t leaders_per_round)
+    : leaders_per_round(std::max<size_t>(leaders_per_round, 1)) {}
 
-// I will re-implement the full consensus.cpp with MysticetiEngine added.
+std::vector<CertificateRef> MysticetiEngine::process_round(Round /*round*/, Dag& dag, State& state, const config::Committee& committee) {
+    if (dag.width() == 0) return {};
+    auto schedule = schedule_for(committee, leaders_per_round);
+    const size_t k = schedule->leaders_per_round();
 
-// --- Mysticeti Engine Implementation ---
+    // Leaders that fell out of the window can no longer be decided.
+    if (next_round < dag.base()) {
+        next_round = dag.base();
+        next_index = 0;
+    }
+    if (dag.highest_round() < next_round + 2) return {};
+    const Round top = dag.highest_round() - 2;
 
-std::vector<Certificate> MysticetiEngine::process_round(Round round, dag_t& dag, State& state, const config::Committee& committee) {
-    // Mysticeti-C Rule: 
-    // Round r: Leader L proposes.
-    // Round r+1: Quorum votes for L.
-    // Round r+2: Commit L if quorum of r+1 blocks point to L.
-
-    if (round < 3) return {};
-
-    Round leader_round = round - 2;
-    if (leader_round <= state.last_committed_round) return {};
-
-    auto leader_pk_opt = get_leader(leader_round, committee);
-    if (!leader_pk_opt) return {};
-    auto leader_pk = *leader_pk_opt;
-
-    // Check if leader exists in DAG
-    auto lit = dag.find(leader_round);
-    if (lit == dag.end() || lit->second.find(leader_pk) == lit->second.end()) return {};
-
-    const auto& [leader_digest, leader_cert] = lit->second.at(leader_pk);
-
-    // Count votes in round r+1
-    Stake votes = 0;
-    auto rit = dag.find(leader_round + 1);
-    if (rit != dag.end()) {
-        for (const auto& [pk, pair] : rit->second) {
-            const auto& cert = pair.second;
-            for (const auto& p : cert.header.parents) {
-                if (p == leader_digest) {
-                    votes += committee.get_stake(cert.origin());
-                    break;
-                }
+    std::vector<LeaderSlot> leaders;
+    for (Round r = next_round; r <= top; ++r) {
+        for (size_t i = (r == next_round ? next_index : 0); i < k; ++i) {
+            leaders.push_back({r, schedule->leader(r, i)});
+        }
+    }
+
+    // Decide top-down so that every anchor is settled before the leaders below it.
+    for (size_t i = leaders.size(); i-- > 0;) {
+        LeaderSlot& leader = leaders[i];
+        leader.decision = decide_direct(leader, dag, committee);
+        if (leader.decision != Decision::Undecided) continue;
+
+        for (size_t j = i + 1; j < leaders.size(); ++j) {
+            const LeaderSlot& anchor = leaders[j];
+            if (anchor.round < leader.round + wave_length) continue;
+            if (anchor.decision == Decision::Skip) continue;
+            if (anchor.decision == Decision::Commit) {
+                leader.decision = decide_from_anchor(leader, anchor, dag, committee);
             }
+            break;
         }
     }
 
-    if (votes < committee.validity_threshold()) return {};
+    std::vector<CertificateRef> sequence;
+    Linearizer linearizer(state);
+    for (const LeaderSlot& leader : leaders) {
+        if (leader.decision == Decision::Undecided) break;
+        if (leader.decision == Decision::Commit) {
+            if (const Vertex* vertex = dag.get(leader.round, leader.slot)) {
+                linearizer.order(*vertex, sequence);
+            }
+        }
+        if (++next_index == k) {
+            next_index = 0;
+            ++next_round;
+        }
+    }
+    return sequence;
+}
 
-    // In Mysticeti, if we see a quorum in r+1, we can commit in r+2
-    // If we are at round 'round', we are looking at leader_round = round - 2.
-    // So 'round' is the round that provides the confirmation of the quorum at round-1.
-    
-    std::cout << "[Mysticeti] Committing Leader at round " << leader_round << std::endl;
+Decision MysticetiEngine::decide_direct(const LeaderSlot& leader, const Dag& dag, const config::Committee& committee) const {
+    Stake certified = 0;
+    certifiers(leader, dag, committee).for_each([&](Dag::Slot slot) { certified += dag.stake_of(slot); });
+    if (certified >= committee.quorum_threshold()) return Decision::Commit;
+
+    // Only vertices whose parents are all known can be counted as not voting.
+    Stake blame = 0;
+    auto voters = dag.round(leader.round + 1);
+    for (Dag::Slot slot = 0; slot < voters.size(); ++slot) {
+        const auto& vertex = voters[slot];
+        if (!vertex || vertex->missing_parents != 0) continue;
+        if (!utils::bits::test(dag.parents(leader.round + 1, slot), leader.slot)) blame += dag.stake_of(slot);
+    }
+    if (blame >= committee.quorum_threshold()) return Decision::Skip;
 
-    // For now, return the leader cert as the commit sequence
-    // (A real implementation would walk back the DAG just like Tusk)
-    std::vector<Certificate> sequence;
-    sequence.push_back(leader_cert);
-    
-    return sequence;
+    return Decision::Undecided;
 }
 
-std::optional<crypto::PublicKey> MysticetiEngine::get_leader(Round round, const config::Committee& committee) {
-    std::vector<crypto::PublicKey> keys;
-    for (const auto& [key, _] : committee.authorities) keys.push_back(key);
-    std::sort(keys.begin(), keys.end());
-    if (keys.empty()) return std::nullopt;
-    return keys[round % keys.size()];
+Decision MysticetiEngine::decide_from_anchor(const LeaderSlot& leader, const LeaderSlot& anchor, const Dag& dag, const config::Committee& committee) const {
+    utils::Bitmap history = dag.reachable({anchor.round, anchor.slot}, leader.round + 2);
+    history &= certifiers(leader, dag, committee).words();
+    return history.any() ? Decision::Commit : Decision::Skip;
 }
 
-bool MysticetiEngine::can_commit(Round round, const dag_t& dag, const config::Committee& committee) {
-    // Placeholder for more complex Mysticeti-FPC or specific commit conditions
-    return true;
+utils::Bitmap MysticetiEngine::certifiers(const LeaderSlot& leader, const Dag& dag, const config::Committee& committee) const {
+    const size_t width = dag.width();
+    utils::Bitmap result(width);
+
+    utils::Bitmap votes(width);
+    auto voters = dag.round(leader.round + 1);
+    for (Dag::Slot slot = 0; slot < voters.size(); ++slot) {
+        if (voters[slot] && utils::bits::test(dag.parents(leader.round + 1, slot), leader.slot)) votes.set(slot);
+    }
+    if (!votes.any()) return result;
+
+    utils::Bitmap support(width);
+    auto candidates = dag.round(leader.round + 2);
+    for (Dag::Slot slot = 0; slot < candidates.size(); ++slot) {
+        if (!candidates[slot]) continue;
+        support.clear();
+        support |= dag.parents(leader.round + 2, slot);
+        support &= votes.words();
+
+        Stake stake = 0;
+        support.for_each([&](Dag::Slot voter) { stake += dag.stake_of(voter); });
+        if (stake >= committee.quorum_threshold()) result.set(slot);
+    }
+    return result;
 }
 
 } // namespace narwhal::consensus
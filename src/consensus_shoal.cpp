@@ -0,0 +1,136 @@
+#include "narwhal/consensus.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace narwhal::consensus {
+
+// --- Shoal++ Engine Implementation ---
+
+ShoalPlusPlusEngine::ShoalPlusPlusEngine(size_t anchors_per_round, size_t reputation_window)
+    : anchors_per_round(std::max<size_t>(anchors_per_round, 1)),
+      reputation_window(std::max<size_t>(reputation_window, 1)) {}
+
+std::vector<CertificateRef> ShoalPlusPlusEngine::process_round(Round /*round*/, Dag& dag, State& state, const config::Committee& committee) {
+    const size_t width = dag.width();
+    if (width == 0) return {};
+    if (!schedule) {
+        reputation.assign(width, 0);
+        schedule = previous = schedule_for(committee, anchors_per_round);
+    }
+
+    // Anchors that fell out of the window can no longer be decided.
+    if (next_round < dag.base()) {
+        next_round = dag.base();
+        next_index = 0;
+    }
+
+    std::vector<CertificateRef> sequence;
+    Linearizer linearizer(state);
+    std::vector<LeaderSlot> anchors;
+    add_candidates(anchors, next_round, next_index, dag.highest_round());
+    std::vector<bool> settled(anchors.size(), false);
+    // Emit up to the first undecided anchor, deciding each only when it is
+    // reached and the later ones only as far as it needs them.
+    for (size_t first = 0; first < anchors.size(); ++first) {
+        const Decision decision = decide(anchors, settled, first, dag, committee);
+        if (decision == Decision::Undecided) break;
+        const LeaderSlot anchor = anchors[first];
+        if (++next_index == schedule_at(anchor.round).leaders_per_round()) {
+            next_index = 0;
+            ++next_round;
+        }
+        if (decision != Decision::Commit) continue;
+
+        const size_t begin = sequence.size();
+        linearizer.order(*dag.get(anchor.round, anchor.slot), sequence);
+        update_reputation(std::span(sequence).subspan(begin), dag);
+        reschedule(anchor.round + 1);
+        // Its sub-DAG changes the schedule from the next round on: the rest
+        // of this round keeps its slots, later rounds are drawn again, and
+        // everything after it is decided again against the new candidates.
+        auto stale = std::find_if(anchors.begin() + first + 1, anchors.end(), [&](const LeaderSlot& later) {
+            return later.round > anchor.round;
+        });
+        anchors.erase(stale, anchors.end());
+        add_candidates(anchors, anchor.round + 1, 0, dag.highest_round());
+        settled.assign(anchors.size(), false);
+    }
+    return sequence;
+}
+
+void ShoalPlusPlusEngine::add_candidates(std::vector<LeaderSlot>& anchors, Round round, size_t index, Round end) const {
+    for (Round r = round; r < end; ++r) {
+        const LeaderSchedule& at = schedule_at(r);
+        for (size_t i = (r == round ? index : 0); i < at.leaders_per_round(); ++i) {
+            anchors.push_back({r, at.leader(r, i)});
+        }
+    }
+}
+
+Decision ShoalPlusPlusEngine::decide(std::vector<LeaderSlot>& anchors, std::vector<bool>& settled, size_t i,
+                                     const Dag& dag, const config::Committee& committee) const {
+    LeaderSlot& anchor = anchors[i];
+    if (settled[i]) return anchor.decision;
+    settled[i] = true;
+    anchor.decision = Decision::Undecided;
+
+    const Vertex* vertex = dag.get(anchor.round, anchor.slot);
+    if (vertex && vertex->support >= committee.validity_threshold()) return anchor.decision = Decision::Commit;
+
+    // Only vertices whose parents are all known can be counted as not referencing it.
+    Stake blame = 0;
+    auto next = dag.round(anchor.round + 1);
+    for (Dag::Slot slot = 0; slot < next.size(); ++slot) {
+        const auto& child = next[slot];
+        if (!child || child->missing_parents != 0) continue;
+        if (!utils::bits::test(dag.parents(anchor.round + 1, slot), anchor.slot)) blame += dag.stake_of(slot);
+    }
+    if (blame >= committee.quorum_threshold()) return anchor.decision = Decision::Skip;
+
+    for (size_t j = i + 1; j < anchors.size(); ++j) {
+        if (anchors[j].round < anchor.round + 2) continue;
+        const Decision later = decide(anchors, settled, j, dag, committee);
+        if (later == Decision::Skip) continue;
+        if (later == Decision::Commit) {
+            bool linked = dag.reachable({anchors[j].round, anchors[j].slot}, anchor.round).test(anchor.slot);
+            anchor.decision = linked ? Decision::Commit : Decision::Skip;
+        }
+        break;
+    }
+    return anchor.decision;
+}
+
+void ShoalPlusPlusEngine::update_reputation(std::span<const CertificateRef> committed, const Dag& dag) {
+    std::vector<Dag::Slot> slots;
+    slots.reserve(committed.size());
+    for (const auto& cert : committed) {
+        if (auto slot = dag.slot_of(cert->origin())) {
+            slots.push_back(*slot);
+            reputation[*slot]++;
+        }
+    }
+    window.push_back(std::move(slots));
+
+    if (window.size() > reputation_window) {
+        for (Dag::Slot slot : window.front()) reputation[slot]--;
+        window.pop_front();
+    }
+}
+
+void ShoalPlusPlusEngine::reschedule(Round from) {
+    // A second commit in the same round keeps the schedule that round started with.
+    if (from != schedule->start()) previous = schedule;
+
+    std::vector<Dag::Slot> order(reputation.size());
+    std::iota(order.begin(), order.end(), Dag::Slot{0});
+    std::stable_sort(order.begin(), order.end(), [&](Dag::Slot a, Dag::Slot b) {
+        return reputation[a] > reputation[b];
+    });
+    // Leave out the f least active authorities.
+    order.resize(order.size() - (order.size() - 1) / 3);
+
+    schedule = std::make_shared<const LeaderSchedule>(std::move(order), anchors_per_round, from);
+    publish(schedule);
+}
+
+} // namespace narwhal::consensus
@@ -9,6 +9,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace narwhal::crypto {
@@ -49,12 +50,26 @@ bool Ed25519::verify(const std::vector<uint8_t>& message, const Signature& signa
 #endif
 }
 
-Digest Hash::compute(const std::vector<uint8_t>& data) {
+Digest Hash::compute(std::span<const uint8_t> data) {
     Digest digest = {0};
 #ifdef USE_INTERNAL_MOCKS
-    // Simple XOR mock hash
-    for (size_t i = 0; i < data.size(); ++i) {
-        digest[i % 32] ^= data[i];
+    // Mock hash: four independently seeded 64-bit lanes mixing the input a word
+    // at a time. Not cryptographic, but unlike a plain XOR fold, distinct inputs
+    // do not collide in practice, so digest-keyed indexes behave as with BLAKE2b.
+    auto mix = [](uint64_t x) {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    };
+    uint64_t lanes[4] = {0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL};
+    for (size_t i = 0; i < data.size(); i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, data.data() + i, std::min<size_t>(8, data.size() - i));
+        for (auto& lane : lanes) lane = mix(lane ^ word);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        uint64_t lane = mix(lanes[i] ^ data.size());
+        std::memcpy(digest.data() + i * 8, &lane, 8);
     }
 #else
     crypto_generichash(digest.data(), digest.size(), data.data(), data.size(), nullptr, 0);
@@ -62,6 +77,38 @@ Digest Hash::compute(const std::vector<uint8_t>& data) {
     return digest;
 }
 
+Signature InsecureAggregate::sign(std::span<const uint8_t> message, const PublicKey& signer) {
+    // Two domain-separated hashes of (tag, signer, message) fill the 64 bytes.
+    std::vector<uint8_t> input(1 + signer.size() + message.size());
+    std::memcpy(input.data() + 1, signer.data(), signer.size());
+    if (!message.empty()) std::memcpy(input.data() + 1 + signer.size(), message.data(), message.size());
+    Signature signature;
+    for (uint8_t half = 0; half < 2; ++half) {
+        input[0] = half;
+        Digest digest = Hash::compute(input);
+        std::memcpy(signature.data() + half * digest.size(), digest.data(), digest.size());
+    }
+    return signature;
+}
+
+Signature InsecureAggregate::aggregate(std::span<const Signature> signatures) const {
+    Signature result = {0};
+    for (const auto& signature : signatures) {
+        for (size_t i = 0; i < result.size(); ++i) result[i] ^= signature[i];
+    }
+    return result;
+}
+
+bool InsecureAggregate::verify(std::span<const uint8_t> message, const Signature& aggregate,
+                               std::span<const PublicKey> signers) const {
+    Signature expected = {0};
+    for (const auto& signer : signers) {
+        Signature signature = sign(message, signer);
+        for (size_t i = 0; i < expected.size(); ++i) expected[i] ^= signature[i];
+    }
+    return !signers.empty() && expected == aggregate;
+}
+
 std::string Hash::to_hex(const Digest& digest) {
     std::stringstream ss;
     ss << std::hex << std::setfill('0');
@@ -1,10 +1,15 @@
 #include "narwhal/consensus.hpp"
+#include "narwhal/verifier.hpp"
+#include "narwhal/shadow.hpp"
 #include "narwhal/network.hpp"
 #include "narwhal/store.hpp"
 #include "narwhal/config.hpp"
 #include "narwhal/common.hpp"
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <string>
 
 #ifndef USE_INTERNAL_MOCKS
@@ -17,6 +22,12 @@ int main(int argc, char* argv[]) {
     uint16_t port = 8000;
     std::string db_path = "./db_primary";
     std::string engine_type = "tusk";
+    size_t verifiers = 0;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    config::Placement executor_placement;
+    config::Placement consensus_placement;
+    std::string record_path;
+    std::vector<std::string> shadow_engines;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -26,6 +37,26 @@ int main(int argc, char* argv[]) {
             db_path = argv[++i];
         } else if (arg == "--engine" && i + 1 < argc) {
             engine_type = argv[++i];
+        } else if (arg == "--verifiers" && i + 1 < argc) {
+            verifiers = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--executor-placement" && i + 1 < argc) {
+            executor_placement = config::Placement::parse(argv[++i]);
+        } else if (arg == "--consensus-placement" && i + 1 < argc) {
+            consensus_placement = config::Placement::parse(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--shadow" && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            for (std::string name; std::getline(list, name, ',');) shadow_engines.push_back(name);
+        }
+    }
+
+    for (const auto* placement : {&executor_placement, &consensus_placement}) {
+        if (!utils::placement_available(*placement)) {
+            std::cerr << "Requested cpus or NUMA node are not available on this machine" << std::endl;
+            return 1;
         }
     }
 
@@ -43,33 +74,75 @@ int main(int argc, char* argv[]) {
     int io_context = 0;
 #endif
 
-    config::Committee committee;
+    std::map<crypto::PublicKey, config::Authority> authorities;
     for (int i = 0; i < 4; i++) {
         crypto::PublicKey pk = {0};
         pk[0] = i; // Unique key for each node
-        committee.authorities[pk] = {100, "127.0.0.1:" + std::to_string(8000 + i), "127.0.0.1:" + std::to_string(9000 + i)};
+        authorities[pk] = {100, "127.0.0.1:" + std::to_string(8000 + i), "127.0.0.1:" + std::to_string(9000 + i)};
     }
+    const config::Committee committee(authorities);
+    const consensus::Round gc_depth = 50;
 
-    auto rx_primary = std::make_shared<utils::Channel<consensus::Certificate>>();
-    auto tx_primary = std::make_shared<utils::Channel<consensus::Certificate>>();
-    auto tx_output = std::make_shared<utils::Channel<consensus::Certificate>>();
+    // Shared worker pool for the node components; declared before them so it
+    // outlives every task they post.
+    utils::Executor executor(threads, executor_placement);
+
+    auto rx_primary = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+    auto tx_primary = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+    auto tx_output = std::make_shared<utils::Channel<consensus::CertificateRef>>();
 
     store::Store store(db_path);
     network::TlsNetwork network(io_context, port, "cert.pem", "key.pem");
 
     // Modular Engine Selection
-    std::unique_ptr<consensus::ConsensusEngine> engine;
-    if (engine_type == "shoal++") {
-        engine = std::make_unique<consensus::ShoalPlusPlusEngine>();
-    } else if (engine_type == "mysticeti") {
-        engine = std::make_unique<consensus::MysticetiEngine>();
+    auto make_engine = [](const std::string& name) {
+        auto engine = consensus::make_engine(name);
+        return engine ? std::move(engine) : consensus::make_engine("tusk");
+    };
+
+    // A consensus placement gives the engine a dedicated, pinned thread;
+    // otherwise it runs on a strand of the shared executor.
+    config::Parameters parameters;
+    parameters.placement = consensus_placement;
+    parameters.record_path = record_path;
+
+    // With --shadow a,b,..., every listed engine runs on the same certificate
+    // stream and the first one drives the output.
+    std::unique_ptr<consensus::Consensus> consensus;
+    std::unique_ptr<consensus::Shadow> shadow;
+    if (!shadow_engines.empty()) {
+        consensus::Shadow::Engines engines;
+        for (const auto& name : shadow_engines) engines.emplace_back(name, make_engine(name));
+        engine_type = shadow_engines.front();
+        shadow = std::make_unique<consensus::Shadow>(committee, gc_depth, rx_primary, tx_output, std::move(engines), parameters);
+        shadow->spawn();
     } else {
-        engine = std::make_unique<consensus::TuskEngine>();
+        consensus = std::make_unique<consensus::Consensus>(committee, gc_depth, rx_primary, tx_primary, tx_output,
+                                                           make_engine(engine_type), parameters);
+        if (consensus_placement.empty()) consensus->spawn(executor);
+        else consensus->spawn();
     }
 
-    consensus::Consensus consensus(committee, 50, rx_primary, tx_primary, tx_output, std::move(engine));
+    // With --verifiers N, each batch of certificates is signature-checked by
+    // up to N executor tasks before it reaches consensus. Verified
+    // certificates go through the inbound filter, which drops a second one
+    // for the same author and round and any the DAG would no longer take.
+    auto ingress = rx_primary;
+    consensus::InboundFilter filter(committee, gc_depth + consensus::Dag::LOOKAHEAD);
+    std::unique_ptr<consensus::Verifier> verifier;
+    if (verifiers > 0) {
+        ingress = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+        verifier = std::make_unique<consensus::Verifier>(committee, executor, verifiers, ingress, rx_primary,
+                                                         256, nullptr, &filter);
+        verifier->spawn();
+    }
 
-    consensus.spawn();
+    // Channels are bounded, so committed certificates fed back to the primary
+    // must be consumed even though nothing acts on them yet.
+    std::vector<consensus::CertificateRef> fed_back(256);
+    utils::Consumer<consensus::CertificateRef> feedback(
+        std::make_shared<utils::Strand>(executor), tx_primary,
+        [&] { while (tx_primary->try_receive_batch(fed_back) != 0) {} });
 
     // Load Generator for Benchmarking
     bool load_enabled = false;
@@ -77,28 +150,31 @@ int main(int argc, char* argv[]) {
 
     std::thread load_gen;
     if (load_enabled) {
-        load_gen = std::thread([rx_primary, committee]() {
+        load_gen = std::thread([ingress, committee]() {
             uint64_t round = 1;
             std::vector<crypto::Digest> previous_round_digests;
             
             // Genesis digests (round 0)
-            for (const auto& [pk, auth] : committee.authorities) {
-                consensus::Certificate genesis_cert;
-                genesis_cert.header.author = pk;
-                genesis_cert.header.round = 0;
-                previous_round_digests.push_back(genesis_cert.digest());
+            for (const auto& genesis_cert : consensus::Consensus::genesis(committee)) {
+                previous_round_digests.push_back(genesis_cert->digest());
             }
 
             while (true) {
+                // Hold back while the pipeline is above its high watermark.
+                ingress->throttle();
                 std::vector<crypto::Digest> current_round_digests;
-                for (const auto& [pk, auth] : committee.authorities) {
-                    consensus::Certificate cert;
-                    cert.header.author = pk;
-                    cert.header.round = round;
-                    cert.header.parents = previous_round_digests;
-
-                    rx_primary->send(cert);
-                    current_round_digests.push_back(cert.digest());
+                for (const auto& [pk, auth] : committee.authorities()) {
+                    consensus::Header header;
+                    header.author = pk;
+                    header.round = round;
+                    header.parents = previous_round_digests;
+                    // Placeholder votes from every authority; only the mock verifier accepts them.
+                    consensus::Votes votes(committee.size());
+                    for (config::Committee::Index voter = 0; voter < committee.size(); ++voter) votes.add(voter, crypto::Signature{});
+                    auto cert = std::make_shared<const consensus::Certificate>(std::move(header), std::move(votes));
+
+                    current_round_digests.push_back(cert->digest());
+                    ingress->send(std::move(cert));
                 }
                 previous_round_digests = std::move(current_round_digests);
                 round++;
@@ -110,23 +186,38 @@ int main(int argc, char* argv[]) {
     auto start_time = std::chrono::steady_clock::now();
     uint64_t commit_count = 0;
 
-    while (true) {
-        auto committed = tx_output->receive();
-        if (committed) {
-            commit_count++;
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
-            
-            if (elapsed >= 5) { // Log every 5 seconds
-                std::cout << "[" << engine_type << "] Perf: " << commit_count / (double)elapsed 
-                          << " certificates/sec (Total: " << commit_count << ")" << std::endl;
-                // We don't reset start_time/count to get global average, or we could for sliding window.
+    std::vector<consensus::CertificateRef> committed(256);
+    while (size_t count = tx_output->receive_batch(committed)) {
+        consensus::Round highest = 0;
+        for (size_t i = 0; i < count; ++i) {
+            highest = std::max(highest, committed[i]->round());
+            if (++commit_count % 10 == 0) { // Still log some individual commits but less spammy
+                std::cout << "[" << engine_type << "] Committed Round " << committed[i]->round() << std::endl;
             }
-
-            if (commit_count % 10 == 0) { // Still log some individual commits but less spammy
-                std::cout << "[" << engine_type << "] Committed Round " << committed->round() << std::endl;
+            committed[i].reset();
+        }
+        // The DAG keeps gc_depth rounds below the last commit.
+        filter.advance(highest > gc_depth ? highest - gc_depth : 0);
+
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
+        
+        if (elapsed >= 5) { // Log every 5 seconds
+            std::cout << "[" << engine_type << "] Perf: " << commit_count / (double)elapsed 
+                      << " certificates/sec (Total: " << commit_count << ")" << std::endl;
+            auto queue = ingress->stats();
+            std::cout << "  [ingress] depth " << queue.depth << "/" << queue.capacity
+                      << (queue.throttled ? " (throttled)" : "") << ", " << queue.stalls << " stalls, "
+                      << std::chrono::duration<double, std::milli>(queue.stall_time).count() << " ms stalled" << std::endl;
+            if (shadow) {
+                for (const auto& r : shadow->report()) {
+                    std::cout << "  [shadow " << r.engine << "] " << r.throughput << " certificates/sec, latency "
+                              << r.mean_latency_ms << " ms mean / " << r.max_latency_ms << " ms max, agrees for "
+                              << r.agrees_until << "/" << r.committed << " commits" << std::endl;
+                }
             }
-        } else break;
+            // We don't reset start_time/count to get global average, or we could for sliding window.
+        }
     }
 
 #ifndef USE_INTERNAL_MOCKS
@@ -0,0 +1,113 @@
+#include "narwhal/recorder.hpp"
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+namespace narwhal::consensus {
+
+namespace {
+// The writer wakes early once this many records are pending, and otherwise
+// flushes every interval, so a node that is killed loses at most a second
+// of input.
+constexpr size_t WAKE_THRESHOLD = 4096;
+constexpr std::chrono::seconds FLUSH_INTERVAL{1};
+} // namespace
+
+Recorder::Recorder(const std::string& path, const config::Committee& committee)
+    : file(path, std::ios::binary | std::ios::trunc) {
+    if (!file) throw std::runtime_error("Recorder: cannot create " + path);
+    std::vector<uint8_t> buffer;
+    utils::Packer::pack_bytes(buffer, replay_log::MAGIC.data(), replay_log::MAGIC.size());
+    utils::Packer::pack_u64(buffer, replay_log::VERSION);
+    utils::Packer::pack_u64(buffer, committee.size());
+    for (const auto& [name, authority] : committee.authorities()) {
+        utils::Packer::pack_bytes(buffer, name.data(), name.size());
+        utils::Packer::pack_u64(buffer, authority.stake);
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    writer = std::thread(&Recorder::write, this);
+}
+
+Recorder::~Recorder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void Recorder::record(CertificateRef certificate, Clock::time_point arrival) {
+    if (!first) first = arrival;
+    auto offset = std::chrono::duration_cast<std::chrono::nanoseconds>(arrival - *first);
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({std::max(offset, std::chrono::nanoseconds::zero()), std::move(certificate)});
+        full = pending.size() == WAKE_THRESHOLD;
+    }
+    if (full) wake.notify_one();
+}
+
+void Recorder::write() {
+    std::vector<Pending> records;
+    std::vector<uint8_t> buffer;
+    for (bool done = false; !done;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, FLUSH_INTERVAL, [this] { return closing || pending.size() >= WAKE_THRESHOLD; });
+            records.swap(pending);
+            done = closing;
+        }
+        if (records.empty()) continue;
+        buffer.clear();
+        for (const auto& record : records) {
+            utils::Packer::pack_u64(buffer, static_cast<uint64_t>(record.offset.count()));
+            const size_t size = record.certificate->serialized_size();
+            utils::Packer::pack_u64(buffer, size);
+            buffer.resize(buffer.size() + size);
+            record.certificate->serialize_into(std::span<uint8_t>(buffer).last(size));
+        }
+        records.clear();
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        file.flush();
+    }
+}
+
+ReplayLog ReplayLog::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("ReplayLog: cannot open " + path);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    utils::Unpacker unpacker(data);
+    if (unpacker.unpack_array<replay_log::MAGIC.size()>() != replay_log::MAGIC) {
+        throw std::runtime_error("ReplayLog: " + path + " is not a replay log");
+    }
+    if (unpacker.unpack_u64() != replay_log::VERSION) throw std::runtime_error("ReplayLog: unsupported version");
+
+    std::map<crypto::PublicKey, config::Authority> authorities;
+    auto members = unpacker.unpack_count(sizeof(crypto::PublicKey) + 8);
+    for (uint64_t i = 0; i < members; ++i) {
+        auto name = unpacker.unpack_array<std::tuple_size_v<crypto::PublicKey>>();
+        authorities[name] = {static_cast<config::Stake>(unpacker.unpack_u64()), "", ""};
+    }
+
+    ReplayLog log;
+    log.committee = config::Committee(authorities);
+    while (!unpacker.done()) {
+        std::chrono::nanoseconds offset;
+        std::vector<uint8_t> bytes;
+        try {
+            offset = std::chrono::nanoseconds(unpacker.unpack_u64());
+            bytes = unpacker.unpack_vector_bytes();
+        } catch (const std::runtime_error&) {
+            // The recording node stopped in the middle of a write.
+            break;
+        }
+        log.entries.push_back({offset, std::make_shared<const Certificate>(Certificate::deserialize(bytes))});
+    }
+    return log;
+}
+
+} // namespace narwhal::consensus
@@ -0,0 +1,144 @@
+#include "narwhal/consensus.hpp"
+#include "narwhal/recorder.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace narwhal;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void usage() {
+    std::cerr << "Usage: replay <log> [--engine tusk|shoal++|mysticeti] [--gc-depth N] [--paced] [--sequence FILE]\n"
+              << "  --paced     feed certificates at the times consensus dequeued them (default: as fast as possible)\n"
+              << "  --sequence  write the committed sequence, one \"round author digest\" line per certificate"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    std::string log_path = argv[1];
+    std::string engine_type = "tusk";
+    consensus::Round gc_depth = 50;
+    bool paced = false;
+    std::string sequence_path;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--engine" && i + 1 < argc) {
+            engine_type = argv[++i];
+        } else if (arg == "--gc-depth" && i + 1 < argc) {
+            gc_depth = std::stoull(argv[++i]);
+        } else if (arg == "--paced") {
+            paced = true;
+        } else if (arg == "--sequence" && i + 1 < argc) {
+            sequence_path = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    auto engine = consensus::make_engine(engine_type);
+    if (!engine) {
+        std::cerr << "Unknown engine " << engine_type << std::endl;
+        return 1;
+    }
+
+    consensus::ReplayLog log;
+    try {
+        log = consensus::ReplayLog::load(log_path);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Replaying " << log.entries.size() << " certificates from " << log_path << " (committee of "
+              << log.committee.size() << ") through " << engine_type << (paced ? ", paced" : "") << std::endl;
+
+    auto rx = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+    auto tx_primary = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+    auto tx_output = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+
+    // When each certificate was fed, by position in the log.
+    std::vector<Clock::time_point> fed(log.entries.size());
+    utils::FlatHashMap<crypto::Digest, size_t> positions;
+    for (size_t i = 0; i < log.entries.size(); ++i) positions.try_emplace(log.entries[i].certificate->digest(), i);
+    std::mutex fed_mutex;
+
+    std::vector<consensus::CertificateRef> sequence;
+    std::vector<Clock::duration> latencies;
+    Clock::time_point last_commit;
+    std::thread collector([&] {
+        while (auto committed = tx_output->receive()) {
+            auto now = Clock::now();
+            auto it = positions.find((*committed)->digest());
+            if (it != positions.end()) {
+                std::lock_guard<std::mutex> lock(fed_mutex);
+                latencies.push_back(now - fed[it->second]);
+            }
+            sequence.push_back(std::move(*committed));
+            last_commit = now;
+        }
+    });
+    std::thread drain([&] { while (tx_primary->receive()) {} });
+
+    auto consensus = std::make_unique<consensus::Consensus>(log.committee, gc_depth, rx, tx_primary, tx_output,
+                                                            std::move(engine));
+    consensus->spawn();
+
+    const auto start = Clock::now();
+    for (size_t i = 0; i < log.entries.size(); ++i) {
+        if (paced) std::this_thread::sleep_until(start + log.entries[i].offset);
+        {
+            std::lock_guard<std::mutex> lock(fed_mutex);
+            fed[i] = Clock::now();
+        }
+        rx->send(log.entries[i].certificate);
+    }
+    rx->close();
+    consensus->join();
+    consensus.reset();
+    tx_output->close();
+    tx_primary->close();
+    collector.join();
+    drain.join();
+
+    using Millis = std::chrono::duration<double, std::milli>;
+    const double elapsed = std::chrono::duration<double>((sequence.empty() ? Clock::now() : last_commit) - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        if (latencies.empty()) return 0.0;
+        return Millis(latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))]).count();
+    };
+    Clock::duration total{};
+    for (auto latency : latencies) total += latency;
+
+    std::cout << "Committed " << sequence.size() << " certificates in " << elapsed << " s ("
+              << (elapsed > 0 ? sequence.size() / elapsed : 0) << " certificates/sec)" << std::endl;
+    std::cout << "Commit latency: mean " << (latencies.empty() ? 0 : Millis(total).count() / latencies.size())
+              << " ms, p50 " << percentile(0.5) << " ms, p99 " << percentile(0.99) << " ms, max " << percentile(1.0)
+              << " ms" << std::endl;
+
+    if (!sequence_path.empty()) {
+        std::ofstream out(sequence_path);
+        for (const auto& certificate : sequence) {
+            out << certificate->round() << " " << crypto::Hash::to_hex(certificate->origin()) << " "
+                << crypto::Hash::to_hex(certificate->digest()) << "\n";
+        }
+        if (!out) {
+            std::cerr << "Could not write " << sequence_path << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
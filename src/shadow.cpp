@@ -0,0 +1,166 @@
+#include "narwhal/shadow.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace narwhal::consensus {
+
+Shadow::Shadow(config::Committee committee, Round gc_depth,
+               std::shared_ptr<utils::Channel<CertificateRef>> rx,
+               std::shared_ptr<utils::Channel<CertificateRef>> tx_output,
+               Engines engines,
+               config::Parameters parameters)
+    : rx(rx), tx_output(tx_output), discard(std::make_shared<utils::Channel<CertificateRef>>()), gc_depth(gc_depth) {
+    for (auto& [name, engine] : engines) {
+        // Every lane sees the same input, so only the reference lane records it.
+        if (!lanes.empty()) parameters.record_path.clear();
+        auto lane = std::make_unique<Lane>();
+        lane->engine = name;
+        lane->rx = std::make_shared<utils::Channel<CertificateRef>>();
+        lane->committed = std::make_shared<utils::Channel<CertificateRef>>();
+        lane->consensus = std::make_unique<Consensus>(committee, gc_depth, lane->rx, discard, lane->committed,
+                                                      std::move(engine), parameters);
+        lanes.push_back(std::move(lane));
+    }
+}
+
+void Shadow::join() {
+    if (dispatcher.joinable()) dispatcher.join();
+    for (auto& lane : lanes) lane->consensus->join();
+    for (auto& lane : lanes) {
+        lane->committed->close();
+        if (lane->collector.joinable()) lane->collector.join();
+    }
+}
+
+Shadow::~Shadow() {
+    if (dispatcher.joinable()) dispatcher.join();
+    for (auto& lane : lanes) lane->consensus.reset();
+    for (auto& lane : lanes) {
+        lane->committed->close();
+        if (lane->collector.joinable()) lane->collector.join();
+    }
+    discard->close();
+    if (drain.joinable()) drain.join();
+}
+
+void Shadow::spawn() {
+    started = Clock::now();
+    drain = std::thread([this] { while (discard->receive()) {} });
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        Lane& lane = *lanes[i];
+        lane.collector = std::thread(&Shadow::collect, this, std::ref(lane), i == 0);
+        lane.consensus->spawn();
+    }
+    dispatcher = std::thread(&Shadow::fan_out, this);
+}
+
+void Shadow::fan_out() {
+    std::vector<CertificateRef> batch(256);
+    size_t count;
+    while ((count = rx->receive_batch(batch)) != 0) {
+        std::span<const CertificateRef> received(batch.data(), count);
+        {
+            std::lock_guard<std::mutex> lock(arrivals_mutex);
+            auto now = Clock::now();
+            const Round floor = committed_round > gc_depth ? committed_round - gc_depth : 0;
+            for (const auto& certificate : received) {
+                if (certificate->round() < floor) continue;
+                if (arrivals.try_emplace(certificate->digest(), Arrival{now, lanes.size()}).second) {
+                    arrival_rounds[certificate->round()].push_back(certificate->digest());
+                }
+            }
+        }
+        for (auto& lane : lanes) lane->rx->send_batch(received);
+    }
+    for (auto& lane : lanes) lane->rx->close();
+}
+
+void Shadow::collect(Lane& lane, bool reference) {
+    std::vector<CertificateRef> batch(256);
+    size_t count;
+    while ((count = lane.committed->receive_batch(batch)) != 0) {
+        std::span<const CertificateRef> committed(batch.data(), count);
+        if (reference) tx_output->send_batch(committed);
+
+        auto now = Clock::now();
+        std::vector<Clock::duration> latencies;
+        latencies.reserve(count);
+        {
+            std::lock_guard<std::mutex> lock(arrivals_mutex);
+            for (const auto& certificate : committed) {
+                auto it = arrivals.find(certificate->digest());
+                if (it == arrivals.end()) continue;
+                latencies.push_back(now - it->second.time);
+                if (--it->second.pending == 0) arrivals.erase(it);
+            }
+            for (const auto& certificate : committed) committed_round = std::max(committed_round, certificate->round());
+            // Drop what has fallen gc_depth rounds behind the furthest lane,
+            // even though a lagging lane may still commit some of it.
+            while (!arrival_rounds.empty() && arrival_rounds.begin()->first + gc_depth < committed_round) {
+                for (const auto& digest : arrival_rounds.begin()->second) arrivals.erase(digest);
+                arrival_rounds.erase(arrival_rounds.begin());
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        lane.samples += latencies.size();
+        for (auto latency : latencies) {
+            lane.latency_sum += latency;
+            lane.latency_max = std::max(lane.latency_max, latency);
+        }
+        for (const auto& certificate : committed) {
+            uint64_t word;
+            std::memcpy(&word, certificate->digest().data(), sizeof(word));
+            lane.sequence_hash = (lane.sequence_hash ^ word) * 0x100000001b3ULL;
+            if (++lane.count % CHECKPOINT == 0) lane.checkpoints.push_back(lane.sequence_hash);
+        }
+        for (auto& certificate : batch) certificate.reset();
+    }
+}
+
+size_t Shadow::tracked() const {
+    std::lock_guard<std::mutex> lock(arrivals_mutex);
+    return arrivals.size();
+}
+
+std::vector<Shadow::Report> Shadow::report() const {
+    using Millis = std::chrono::duration<double, std::milli>;
+    const double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+    std::vector<uint64_t> reference;
+    uint64_t reference_count = 0;
+    uint64_t reference_hash = 0;
+    std::vector<Report> reports;
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        const Lane& lane = *lanes[i];
+        std::lock_guard<std::mutex> lock(lane.mutex);
+
+        Report r;
+        r.engine = lane.engine;
+        r.committed = lane.count;
+        r.throughput = elapsed > 0 ? lane.count / elapsed : 0;
+        r.mean_latency_ms = lane.samples ? Millis(lane.latency_sum).count() / lane.samples : 0;
+        r.max_latency_ms = Millis(lane.latency_max).count();
+
+        if (i == 0) {
+            reference = lane.checkpoints;
+            reference_count = lane.count;
+            reference_hash = lane.sequence_hash;
+            r.agrees_until = lane.count;
+        } else if (lane.count == reference_count && lane.sequence_hash == reference_hash) {
+            // Caught up with the reference on the same sequence, past the last checkpoint.
+            r.agrees_until = lane.count;
+        } else {
+            size_t matching = 0;
+            while (matching < std::min(reference.size(), lane.checkpoints.size()) &&
+                   reference[matching] == lane.checkpoints[matching]) {
+                ++matching;
+            }
+            r.agrees_until = matching * CHECKPOINT;
+        }
+        reports.push_back(std::move(r));
+    }
+    return reports;
+}
+
+} // namespace narwhal::consensus
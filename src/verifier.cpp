@@ -0,0 +1,133 @@
+#include "narwhal/verifier.hpp"
+#include <algorithm>
+
+namespace narwhal::consensus {
+
+Verifier::Verifier(config::Committee committee, utils::Executor& executor, size_t workers,
+                   std::shared_ptr<utils::Channel<CertificateRef>> rx,
+                   std::shared_ptr<utils::Channel<CertificateRef>> tx,
+                   size_t max_batch_size,
+                   const crypto::AggregateScheme* aggregates,
+                   InboundFilter* filter,
+                   SlotTable* slots)
+    : committee(std::move(committee)), executor(executor), workers(std::max<size_t>(workers, 1)),
+      rx(rx), tx(tx), aggregates(aggregates), filter(filter), slots(slots),
+      batch(std::max<size_t>(max_batch_size, 1)) {}
+
+Verifier::~Verifier() {
+    // The outbox resumes the consumer, so it lets go of it first.
+    if (outbox) outbox->detach();
+    consumer.reset();
+}
+
+void Verifier::spawn() {
+    outbox = std::make_unique<utils::Outbox<CertificateRef>>(tx, [this] { consumer->resume(); });
+    consumer = std::make_unique<utils::Consumer<CertificateRef>>(
+        std::make_shared<utils::Strand>(executor), rx, [this] { drain(); }, true);
+    consumer->resume();
+}
+
+bool Verifier::has_quorum(const Certificate& certificate, const config::Committee& committee) {
+    const Votes& votes = certificate.votes;
+    if (votes.width() != committee.size()) return false;
+    config::Stake weight = 0;
+    votes.signers().for_each([&](size_t index) { weight += committee.stake(static_cast<config::Committee::Index>(index)); });
+    return weight >= committee.quorum_threshold();
+}
+
+void Verifier::drain() {
+    size_t count;
+    // No new batch while verified certificates are held back, so a full
+    // `tx` still holds back `rx`.
+    while (flushed() && (count = rx->try_receive_batch(batch)) != 0) verify(count);
+    if (!closed && outbox->empty() && rx->is_closed() && rx->empty()) {
+        closed = true;
+        tx->close();
+    }
+}
+
+bool Verifier::flushed() {
+    if (outbox->empty()) return true;
+    // Paused before flushing, so room freed in between still resumes it.
+    consumer->pause();
+    if (!outbox->flush()) return false;
+    consumer->resume();
+    return true;
+}
+
+void Verifier::verify(size_t count) {
+    auto pass = std::make_shared<Pass>();
+    pass->certificates.assign(std::make_move_iterator(batch.begin()),
+                              std::make_move_iterator(batch.begin() + count));
+    pass->messages.resize(count);
+    pass->rejected = std::make_unique<std::atomic<bool>[]>(count);
+    pass->committee = &committee;
+    pass->aggregates = aggregates;
+
+    // Stake checks are cheap; only certificates that pass them cost signature checks.
+    for (size_t i = 0; i < count; ++i) {
+        const Certificate& certificate = *pass->certificates[i];
+        const bool aggregated = certificate.votes.mode() == Votes::Mode::AGGREGATE;
+        bool quorum = has_quorum(certificate, committee) && (!aggregated || aggregates);
+        pass->rejected[i].store(!quorum, std::memory_order_relaxed);
+        if (!quorum) continue;
+
+        const auto& digest = certificate.digest();
+        pass->messages[i].assign(digest.begin(), digest.end());
+        if (aggregated) {
+            pass->jobs.push_back({static_cast<uint32_t>(i), 0, 0});
+            continue;
+        }
+        uint32_t vote = 0;
+        certificate.votes.signers().for_each([&](size_t signer) {
+            pass->jobs.push_back({static_cast<uint32_t>(i), vote++, static_cast<uint32_t>(signer)});
+        });
+    }
+
+    // This task works through the jobs as well, so the batch completes even
+    // if no helper gets a worker; it only waits for jobs already claimed.
+    size_t helpers = std::min(workers, pass->jobs.size());
+    for (size_t i = 1; i < helpers; ++i) executor.post([pass] { pass->work(); });
+    pass->work();
+    size_t finished;
+    while ((finished = pass->finished.load()) < pass->jobs.size()) pass->finished.wait(finished);
+
+    std::vector<CertificateRef> verified;
+    verified.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (pass->rejected[i].load(std::memory_order_relaxed)) continue;
+        if (filter && !filter->record(*pass->certificates[i])) continue;
+        if (slots) slots->insert(*pass->certificates[i]);
+        verified.push_back(std::move(pass->certificates[i]));
+    }
+    outbox->send_batch(verified);
+}
+
+void Verifier::Pass::work() {
+    for (;;) {
+        size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= jobs.size()) return;
+
+        const Job& job = jobs[index];
+        if (!rejected[job.certificate].load(std::memory_order_relaxed)) {
+            const Votes& votes = certificates[job.certificate]->votes;
+            const auto& signature = votes.signatures()[job.vote];
+            bool valid;
+            if (votes.mode() == Votes::Mode::AGGREGATE) {
+                std::vector<crypto::PublicKey> signers;
+                votes.signers().for_each([&](size_t signer) {
+                    signers.push_back(committee->key(static_cast<config::Committee::Index>(signer)));
+                });
+                valid = aggregates->verify(messages[job.certificate], signature, signers);
+            } else {
+                valid = crypto::Ed25519::verify(messages[job.certificate], signature, committee->key(job.signer));
+            }
+            if (!valid) {
+                rejected[job.certificate].store(true, std::memory_order_relaxed);
+            }
+        }
+        if (finished.fetch_add(1) + 1 == jobs.size()) finished.notify_all();
+    }
+}
+
+} // namespace narwhal::consensus
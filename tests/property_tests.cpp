@@ -1,7 +1,23 @@
 #include <rapidcheck.h>
 #include "narwhal/consensus.hpp"
+#include "narwhal/certificate_view.hpp"
+#include "narwhal/compact_certificate.hpp"
 #include "narwhal/crypto.hpp"
+#include "narwhal/flat_hash_map.hpp"
+#include "narwhal/shadow.hpp"
+#include "narwhal/verifier.hpp"
+#include "narwhal/write_queue.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_map>
 
 using namespace narwhal;
 
@@ -32,12 +48,10 @@ struct Arbitrary<crypto::PublicKey> {
 template<>
 struct Arbitrary<consensus::Certificate> {
     static Gen<consensus::Certificate> arbitrary() {
-        return gen::build<consensus::Certificate>(
-            gen::set(&consensus::Certificate::header,
-                gen::build<consensus::Header>(
-                    gen::set(&consensus::Header::author, gen::arbitrary<crypto::PublicKey>()),
-                    gen::set(&consensus::Header::round, gen::inRange<uint64_t>(0, 100))
-                )
+        return gen::construct<consensus::Certificate>(
+            gen::build<consensus::Header>(
+                gen::set(&consensus::Header::author, gen::arbitrary<crypto::PublicKey>()),
+                gen::set(&consensus::Header::round, gen::inRange<uint64_t>(0, 100))
             )
         );
     }
@@ -45,6 +59,140 @@ struct Arbitrary<consensus::Certificate> {
 
 } // namespace rc
 
+// ============================================================================
+// DAG helpers
+// ============================================================================
+
+namespace {
+
+config::Committee make_committee(size_t size) {
+    std::map<crypto::PublicKey, config::Authority> authorities;
+    for (size_t i = 0; i < size; ++i) {
+        crypto::PublicKey pk = {0};
+        pk[0] = static_cast<uint8_t>(i);
+        authorities[pk] = {1, "", ""};
+    }
+    return config::Committee(authorities);
+}
+
+// `rounds` full rounds over genesis, each vertex linking a random quorum
+// (or more) of the previous round in slot order.
+std::vector<consensus::CertificateRef> random_dag(const config::Committee& committee, consensus::Round rounds,
+                                                  std::mt19937_64& rng) {
+    const size_t n = committee.size();
+    std::vector<consensus::CertificateRef> dag;
+    std::vector<crypto::Digest> previous;
+    for (const auto& cert : consensus::Consensus::genesis(committee)) previous.push_back(cert->digest());
+    for (consensus::Round round = 1; round <= rounds; ++round) {
+        std::vector<crypto::Digest> current;
+        for (config::Committee::Index author = 0; author < n; ++author) {
+            std::vector<size_t> slots(n);
+            std::iota(slots.begin(), slots.end(), 0);
+            std::shuffle(slots.begin(), slots.end(), rng);
+            const size_t quorum = committee.quorum_threshold();
+            const size_t links = quorum + rng() % (n - quorum + 1);
+            std::sort(slots.begin(), slots.begin() + links);
+
+            consensus::Header header;
+            header.author = committee.key(author);
+            header.round = round;
+            for (size_t i = 0; i < links; ++i) header.parents.push_back(previous[slots[i]]);
+            dag.push_back(std::make_shared<const consensus::Certificate>(std::move(header)));
+            current.push_back(dag.back()->digest());
+        }
+        previous = std::move(current);
+    }
+    return dag;
+}
+
+// A random delivery order in which every certificate follows its parents.
+std::vector<consensus::CertificateRef> causal_order(const config::Committee& committee,
+                                                    std::vector<consensus::CertificateRef> left,
+                                                    std::mt19937_64& rng) {
+    std::set<crypto::Digest> delivered;
+    for (const auto& cert : consensus::Consensus::genesis(committee)) delivered.insert(cert->digest());
+    std::vector<consensus::CertificateRef> order;
+    while (!left.empty()) {
+        std::vector<size_t> ready;
+        for (size_t i = 0; i < left.size(); ++i) {
+            const auto& parents = left[i]->header().parents;
+            if (std::all_of(parents.begin(), parents.end(), [&](const auto& p) { return delivered.count(p) > 0; })) {
+                ready.push_back(i);
+            }
+        }
+        const size_t pick = ready[rng() % ready.size()];
+        delivered.insert(left[pick]->digest());
+        order.push_back(std::move(left[pick]));
+        left.erase(left.begin() + pick);
+    }
+    return order;
+}
+
+// One certificate per author in `authors`, each linking every digest in `parents`.
+std::vector<consensus::CertificateRef> make_round(const config::Committee& committee, consensus::Round round,
+                                                  const std::vector<config::Committee::Index>& authors,
+                                                  const std::vector<crypto::Digest>& parents) {
+    std::vector<consensus::CertificateRef> certs;
+    for (auto author : authors) {
+        consensus::Header header;
+        header.author = committee.key(author);
+        header.round = round;
+        header.parents = parents;
+        certs.push_back(std::make_shared<const consensus::Certificate>(std::move(header)));
+    }
+    return certs;
+}
+
+std::vector<crypto::Digest> digests_of(const std::vector<consensus::CertificateRef>& certs) {
+    std::vector<crypto::Digest> digests;
+    for (const auto& cert : certs) digests.push_back(cert->digest());
+    return digests;
+}
+
+// Feeds certificates one at a time the way Consensus::process does and
+// returns the committed sequence.
+std::vector<crypto::Digest> commit_sequence(consensus::ConsensusEngine& engine, const config::Committee& committee,
+                                            const std::vector<consensus::CertificateRef>& order) {
+    consensus::State state(committee, 50, consensus::Consensus::genesis(committee));
+    std::vector<crypto::Digest> committed;
+    auto commit = [&](const std::vector<consensus::CertificateRef>& sequence) {
+        for (const auto& cert : sequence) committed.push_back(cert->digest());
+        state.update(sequence);
+    };
+    for (const auto& cert : order) {
+        auto inserted = state.dag.insert(cert);
+        for (const auto& position : inserted.supported) {
+            const auto* vertex = state.dag.get(position.round, position.slot);
+            if (vertex) commit(engine.on_supported(*vertex, state.dag, state, committee));
+        }
+        commit(engine.process_round(cert->round(), state.dag, state, committee));
+    }
+    return committed;
+}
+
+// Runs `order` through a Shadow over the named engines until every lane has
+// drained it. Returns the final reports and the sequence forwarded to the
+// output channel.
+std::pair<std::vector<consensus::Shadow::Report>, std::vector<crypto::Digest>>
+shadow_run(const std::vector<std::string>& names, const config::Committee& committee,
+           const std::vector<consensus::CertificateRef>& order) {
+    consensus::Shadow::Engines engines;
+    for (const auto& name : names) engines.emplace_back(name, consensus::make_engine(name));
+    auto rx = std::make_shared<utils::Channel<consensus::CertificateRef>>();
+    auto tx_output = std::make_shared<utils::Channel<consensus::CertificateRef>>(std::bit_ceil(order.size() + 1));
+    consensus::Shadow shadow(committee, 50, rx, tx_output, std::move(engines));
+    shadow.spawn();
+    rx->send_batch(order);
+    rx->close();
+    shadow.join();
+
+    std::vector<consensus::CertificateRef> forwarded(order.size());
+    forwarded.resize(tx_output->try_receive_batch(forwarded));
+    return {shadow.report(), digests_of(forwarded)};
+}
+
+} // namespace
+
 // ============================================================================
 // Property Tests
 // ============================================================================
@@ -63,6 +211,18 @@ void test_certificate_digest_deterministic() {
     });
 }
 
+/**
+ * Property: Cached digest matches the header
+ * 
+ * The digest memoized at construction must equal a fresh hash of the header.
+ */
+void test_certificate_digest_cached() {
+    rc::check("Cached certificate digest matches the header hash", []() {
+        auto cert = *rc::gen::arbitrary<consensus::Certificate>();
+        RC_ASSERT(cert.digest() == crypto::Hash::compute(cert.header().serialize()));
+    });
+}
+
 /**
  * Property: Round monotonicity in committed sequence
  * 
@@ -93,6 +253,401 @@ void test_mysticeti_round_monotonicity() {
     });
 }
 
+/**
+ * Property: Mysticeti commits each certificate at most once
+ * 
+ * Drives the engine over a DAG where every vertex drops a random parent, and
+ * checks that no certificate appears twice in the committed sequence.
+ */
+void test_mysticeti_commits_once() {
+    rc::check("Mysticeti commits each certificate at most once", []() {
+        std::map<crypto::PublicKey, config::Authority> authorities;
+        for (uint8_t i = 0; i < 4; ++i) {
+            crypto::PublicKey pk = {0};
+            pk[0] = i;
+            authorities[pk] = {1, "", ""};
+        }
+        const config::Committee committee(authorities);
+        const auto rounds = *rc::gen::inRange<uint64_t>(1, 20);
+
+        consensus::State state(committee, 50, consensus::Consensus::genesis(committee));
+        consensus::MysticetiEngine engine;
+        std::set<crypto::Digest> committed;
+
+        std::vector<crypto::Digest> previous;
+        for (const auto& cert : consensus::Consensus::genesis(committee)) previous.push_back(cert->digest());
+        for (uint64_t round = 1; round <= rounds; ++round) {
+            std::vector<crypto::Digest> current;
+            for (const auto& [name, authority] : committee.authorities()) {
+                consensus::Header header;
+                header.author = name;
+                header.round = round;
+                const auto dropped = *rc::gen::inRange<size_t>(0, previous.size() + 1);
+                for (size_t i = 0; i < previous.size(); ++i) {
+                    if (i != dropped) header.parents.push_back(previous[i]);
+                }
+                auto cert = std::make_shared<const consensus::Certificate>(std::move(header));
+                current.push_back(cert->digest());
+                state.dag.insert(cert);
+
+                auto sequence = engine.process_round(round, state.dag, state, committee);
+                for (const auto& x : sequence) RC_ASSERT(committed.insert(x->digest()).second);
+                state.update(sequence);
+            }
+            previous = std::move(current);
+        }
+    });
+}
+
+/**
+ * Property: Commits do not depend on delivery order
+ *
+ * The same DAG delivered in two different causal orders groups leader
+ * commits differently, but must yield the same committed sequence.
+ */
+void test_commit_order_independent() {
+    rc::check("Engines commit the same sequence whatever the delivery order", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto dag = random_dag(committee, 16, rng);
+        const auto first = causal_order(committee, dag, rng);
+        const auto second = causal_order(committee, dag, rng);
+
+        for (const std::string name : {"tusk", "shoal++", "mysticeti"}) {
+            auto a = consensus::make_engine(name);
+            auto b = consensus::make_engine(name);
+            RC_ASSERT(commit_sequence(*a, committee, first) == commit_sequence(*b, committee, second));
+        }
+    });
+}
+
+/**
+ * Property: Shoal++ commits an anchor on f+1 support
+ *
+ * The round-1 anchor stays undecided with f references from round 2 and is
+ * committed by the next one, without waiting for round 3.
+ */
+void test_shoal_direct_commit() {
+    rc::check("Shoal++ commits an anchor directly on f+1 support", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 11));
+        std::vector<config::Committee::Index> all(committee.size());
+        std::iota(all.begin(), all.end(), 0);
+        const auto round1 = make_round(committee, 1, all, digests_of(consensus::Consensus::genesis(committee)));
+        const auto round2 = make_round(committee, 2, all, digests_of(round1));
+
+        consensus::State state(committee, 50, consensus::Consensus::genesis(committee));
+        consensus::ShoalPlusPlusEngine engine(1);
+        for (const auto& cert : round1) state.dag.insert(cert);
+        const auto anchor = state.dag.get(1, consensus::LeaderSchedule(committee).leader(1))->certificate;
+
+        const size_t f = committee.validity_threshold() - 1;
+        for (size_t i = 0; i < f; ++i) {
+            state.dag.insert(round2[i]);
+            RC_ASSERT(engine.process_round(2, state.dag, state, committee).empty());
+        }
+        state.dag.insert(round2[f]);
+        auto sequence = engine.process_round(2, state.dag, state, committee);
+        RC_ASSERT(!sequence.empty());
+        RC_ASSERT(sequence.back()->digest() == anchor->digest());
+    });
+}
+
+/**
+ * Property: Shoal++ decides a weak anchor through a later one
+ *
+ * Only 2f round-2 certificates have arrived and at most f of them reference
+ * the round-1 anchor, so neither direct rule applies and the round-3 anchor
+ * decides it: commit if one of those references links it into the later
+ * anchor's history, skip if there are none.
+ */
+void test_shoal_indirect_commit() {
+    rc::check("Shoal++ decides a weak anchor through a later anchor", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 11));
+        const bool linked = *rc::gen::inRange(0, 2) == 1;
+        std::vector<config::Committee::Index> all(committee.size());
+        std::iota(all.begin(), all.end(), 0);
+        const auto anchor_slot = consensus::LeaderSchedule(committee).leader(1);
+
+        const auto round1 = make_round(committee, 1, all, digests_of(consensus::Consensus::genesis(committee)));
+        auto without = digests_of(round1);
+        without.erase(without.begin() + anchor_slot);
+        const size_t f = committee.validity_threshold() - 1;
+        const size_t supporters = linked ? f : 0;
+        std::vector<consensus::CertificateRef> order = round1;
+        std::vector<crypto::Digest> round2;
+        for (config::Committee::Index author = 0; author < 2 * f; ++author) {
+            auto cert = make_round(committee, 2, {author}, author < supporters ? digests_of(round1) : without)[0];
+            round2.push_back(cert->digest());
+            order.push_back(std::move(cert));
+        }
+        const auto round3 = make_round(committee, 3, all, round2);
+        const auto round4 = make_round(committee, 4, all, digests_of(round3));
+        order.insert(order.end(), round3.begin(), round3.end());
+        order.insert(order.end(), round4.begin(), round4.end());
+
+        consensus::ShoalPlusPlusEngine engine(1);
+        const auto sequence = commit_sequence(engine, committee, order);
+        const auto at = std::find(sequence.begin(), sequence.end(), round1[anchor_slot]->digest());
+        RC_ASSERT((at != sequence.end()) == linked);
+        // Committed as an anchor, ahead of every round-2 certificate.
+        for (const auto& digest : round2) {
+            RC_ASSERT(!linked || at < std::find(sequence.begin(), sequence.end(), digest));
+        }
+    });
+}
+
+/**
+ * Property: Shoal++ reschedules around inactive authorities
+ *
+ * f authorities stop after a few rounds. Once their certificates leave the
+ * reputation window, the published schedule excludes them.
+ */
+void test_shoal_reputation_reschedule() {
+    rc::check("Shoal++ drops inactive authorities from the schedule", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 11));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto stop = *rc::gen::inRange<consensus::Round>(1, 8);
+        std::vector<config::Committee::Index> all(committee.size());
+        std::iota(all.begin(), all.end(), 0);
+        std::shuffle(all.begin(), all.end(), rng);
+        const size_t f = committee.validity_threshold() - 1;
+        const std::vector<config::Committee::Index> crashed(all.begin(), all.begin() + f);
+        std::vector<config::Committee::Index> active(all.begin() + f, all.end());
+        std::sort(all.begin(), all.end());
+        std::sort(active.begin(), active.end());
+
+        std::vector<consensus::CertificateRef> order;
+        auto parents = digests_of(consensus::Consensus::genesis(committee));
+        for (consensus::Round round = 1; round <= 64; ++round) {
+            auto certs = make_round(committee, round, round <= stop ? all : active, parents);
+            parents = digests_of(certs);
+            order.insert(order.end(), certs.begin(), certs.end());
+        }
+
+        consensus::ShoalPlusPlusEngine engine(2, 16);
+        RC_ASSERT(!commit_sequence(engine, committee, order).empty());
+        const auto schedule = engine.leader_schedule();
+        RC_ASSERT(schedule->order().size() == active.size());
+        for (auto slot : schedule->order()) {
+            RC_ASSERT(std::find(crashed.begin(), crashed.end(), slot) == crashed.end());
+        }
+    });
+}
+
+/**
+ * Property: Batched ingestion commits what unbatched ingestion does
+ *
+ * With max_batch_size and max_batch_delay set, the consensus loop inserts
+ * whatever arrives within the delay before running the commit rule. A
+ * producer that pauses now and then leaves some batches partial, so both
+ * the size and the deadline end a batch. The committed sequence must not
+ * change.
+ */
+void test_batched_ingestion_matches_unbatched() {
+    rc::check("Batching certificate ingestion does not change commits", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto order = causal_order(committee, random_dag(committee, 12, rng), rng);
+        auto expected = commit_sequence(*consensus::make_engine("tusk"), committee, order);
+
+        config::Parameters parameters;
+        parameters.max_batch_size = *rc::gen::inRange<size_t>(2, 64);
+        parameters.max_batch_delay = std::chrono::microseconds(*rc::gen::inRange<int64_t>(1, 500));
+
+        using Channel = utils::Channel<consensus::CertificateRef>;
+        auto rx = std::make_shared<Channel>();
+        auto tx_primary = std::make_shared<Channel>();
+        auto tx_output = std::make_shared<Channel>();
+        consensus::Consensus consensus(committee, 50, rx, tx_primary, tx_output, consensus::make_engine("tusk"),
+                                       parameters);
+        consensus.spawn();
+        for (size_t i = 0; i < order.size(); ++i) {
+            rx->send(order[i]);
+            if (rng() % 8 == 0) std::this_thread::sleep_for(std::chrono::microseconds(rng() % 1000));
+        }
+        rx->close();
+        consensus.join();
+
+        std::vector<consensus::CertificateRef> output(order.size());
+        output.resize(tx_output->try_receive_batch(output));
+        auto committed = digests_of(output);
+        RC_ASSERT(committed == expected);
+    });
+}
+
+/**
+ * Property: The executor pipeline completes on a single worker
+ *
+ * Verifier, Consensus and the consumers of its outputs all share one
+ * executor thread and every channel holds two certificates, so any stage
+ * that waited for room would wait for itself. The pipeline must still
+ * commit the whole sequence.
+ */
+void test_executor_pipeline_single_thread() {
+    rc::check("Executor pipeline completes on one worker with full channels", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        std::vector<consensus::CertificateRef> dag;
+        for (const auto& cert : random_dag(committee, 12, rng)) {
+            consensus::Votes votes(committee.size());
+            for (config::Committee::Index voter = 0; voter < committee.size(); ++voter) votes.add(voter, crypto::Signature{});
+            dag.push_back(std::make_shared<const consensus::Certificate>(cert->header(), std::move(votes)));
+        }
+        auto expected = commit_sequence(*consensus::make_engine("tusk"), committee, dag);
+        RC_ASSERT(!expected.empty());
+
+        using Channel = utils::Channel<consensus::CertificateRef>;
+        auto ingress = std::make_shared<Channel>(2);
+        auto rx = std::make_shared<Channel>(2);
+        auto tx_primary = std::make_shared<Channel>(2);
+        auto tx_output = std::make_shared<Channel>(2);
+        utils::Executor executor(1);
+
+        std::vector<consensus::CertificateRef> fed_back(1), output(1);
+        std::vector<crypto::Digest> committed;
+        std::atomic<size_t> count{0};
+        utils::Consumer<consensus::CertificateRef> feedback(
+            std::make_shared<utils::Strand>(executor), tx_primary,
+            [&] { while (tx_primary->try_receive_batch(fed_back) != 0) {} });
+        utils::Consumer<consensus::CertificateRef> collector(
+            std::make_shared<utils::Strand>(executor), tx_output, [&] {
+                while (tx_output->try_receive_batch(output) != 0) {
+                    committed.push_back(output[0]->digest());
+                    count.fetch_add(1);
+                }
+            });
+        consensus::Consensus consensus(committee, 50, rx, tx_primary, tx_output, consensus::make_engine("tusk"));
+        consensus.spawn(executor);
+        consensus::Verifier verifier(committee, executor, 2, ingress, rx, 2);
+        verifier.spawn();
+
+        std::thread producer([&] { for (const auto& cert : dag) ingress->send(cert); });
+        producer.join();
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (count.load() < expected.size() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        RC_ASSERT(count.load() == expected.size());
+        RC_ASSERT(committed == expected);
+    });
+}
+
+/**
+ * Property: Identical shadow lanes agree throughout
+ *
+ * Two lanes running the same engine on the fanned-out stream commit the
+ * same sequence, the reference lane's commits reach the output channel,
+ * and the second lane is reported to agree for every commit.
+ */
+void test_shadow_identical_engines_agree() {
+    rc::check("Shadow lanes with the same engine agree on every commit", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto order = causal_order(committee, random_dag(committee, 16, rng), rng);
+        auto expected = commit_sequence(*consensus::make_engine("tusk"), committee, order);
+
+        auto [reports, forwarded] = shadow_run({"tusk", "tusk"}, committee, order);
+        RC_ASSERT(forwarded == expected);
+        RC_ASSERT(reports.size() == 2u);
+        for (const auto& report : reports) {
+            RC_ASSERT(report.committed == expected.size());
+            RC_ASSERT(report.agrees_until == expected.size());
+        }
+    });
+}
+
+/**
+ * Property: Shadow reports a diverging lane
+ *
+ * With a different engine in the second lane, only the reference lane
+ * feeds the output, and a lane whose sequence differs from it is not
+ * reported as agreeing throughout.
+ */
+void test_shadow_different_engines_diverge() {
+    rc::check("Shadow reports divergence between different engines", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto order = causal_order(committee, random_dag(committee, 16, rng), rng);
+        auto reference = commit_sequence(*consensus::make_engine("tusk"), committee, order);
+        auto other = commit_sequence(*consensus::make_engine("mysticeti"), committee, order);
+        RC_PRE(reference != other);
+
+        auto [reports, forwarded] = shadow_run({"tusk", "mysticeti"}, committee, order);
+        RC_ASSERT(forwarded == reference);
+        RC_ASSERT(reports[0].committed == reference.size());
+        RC_ASSERT(reports[1].committed == other.size());
+        RC_ASSERT(reports[0].agrees_until == reference.size());
+        RC_ASSERT(reports[1].agrees_until < std::max(reports[0].committed, reports[1].committed));
+    });
+}
+
+/**
+ * Property: Shadow forgets fan-out times below the garbage-collected rounds
+ *
+ * A random DAG leaves some certificates without children, which no engine
+ * ever commits, and two different engines commit different parts of the
+ * rest at different times. Fan-out times are still held only for rounds
+ * within gc_depth of the highest committed one.
+ */
+void test_shadow_arrivals_bounded() {
+    rc::check("Shadow holds fan-out times only for recent rounds", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto order = causal_order(committee, random_dag(committee, 120, rng), rng);
+        const consensus::Round gc_depth = *rc::gen::inRange<consensus::Round>(2, 20);
+
+        consensus::Shadow::Engines engines;
+        engines.emplace_back("tusk", consensus::make_engine("tusk"));
+        engines.emplace_back("mysticeti", consensus::make_engine("mysticeti"));
+        auto rx = std::make_shared<utils::Channel<consensus::CertificateRef>>(std::bit_ceil(order.size() + 1));
+        auto tx_output = std::make_shared<utils::Channel<consensus::CertificateRef>>(std::bit_ceil(order.size() + 1));
+        consensus::Shadow shadow(committee, gc_depth, rx, tx_output, std::move(engines));
+        shadow.spawn();
+        rx->send_batch(order);
+        rx->close();
+        shadow.join();
+
+        std::vector<consensus::CertificateRef> committed(order.size());
+        committed.resize(tx_output->try_receive_batch(committed));
+        RC_PRE(!committed.empty());
+        consensus::Round highest = 0;
+        for (const auto& cert : committed) highest = std::max(highest, cert->round());
+        const auto recent = std::count_if(order.begin(), order.end(), [&](const auto& cert) {
+            return cert->round() + gc_depth >= highest;
+        });
+        RC_ASSERT(shadow.tracked() <= static_cast<size_t>(recent));
+    });
+}
+
+/**
+ * Property: The DAG refuses rounds far past the committed one
+ *
+ * A certificate more than LOOKAHEAD rounds past the last committed round,
+ * up to the largest round there is, is refused without resizing the ring;
+ * one at the bound is still accepted.
+ */
+void test_dag_bounds_lookahead() {
+    rc::check("DAG refuses certificates beyond its lookahead", []() {
+        const auto committee = make_committee(4);
+        const consensus::Round gc_depth = *rc::gen::inRange<consensus::Round>(1, 100);
+        consensus::State state(committee, gc_depth, consensus::Consensus::genesis(committee));
+        const consensus::Round limit = gc_depth + consensus::Dag::LOOKAHEAD;
+
+        auto at = [&](consensus::Round round) {
+            consensus::Header header;
+            header.author = committee.key(*rc::gen::inRange<config::Committee::Index>(0, 4));
+            header.round = round;
+            return std::make_shared<const consensus::Certificate>(std::move(header));
+        };
+        const auto far = *rc::gen::inRange<consensus::Round>(limit + 1, UINT64_MAX);
+        RC_ASSERT(!state.dag.insert(at(far)).inserted);
+        RC_ASSERT(!state.dag.insert(at(UINT64_MAX)).inserted);
+        RC_ASSERT(state.dag.highest_round() == 0);
+        RC_ASSERT(state.dag.insert(at(limit)).inserted);
+        RC_ASSERT(state.dag.highest_round() == limit);
+    });
+}
+
 /**
  * Property: No equivocation in DAG
  * 
@@ -120,6 +675,293 @@ void test_no_equivocation() {
     });
 }
 
+/**
+ * Property: FlatHashMap behaves like std::unordered_map
+ *
+ * Applies a random sequence of inserts and erases over a small key space
+ * (so keys are erased and reinserted over tombstones) to both maps and
+ * compares their contents after every step.
+ */
+void test_flat_hash_map_matches_unordered_map() {
+    rc::check("FlatHashMap matches std::unordered_map", []() {
+        const auto ops = *rc::gen::container<std::vector<std::pair<bool, uint8_t>>>(
+            rc::gen::pair(rc::gen::arbitrary<bool>(), rc::gen::inRange<uint8_t>(0, 64)));
+
+        utils::FlatHashMap<crypto::Digest, uint32_t> flat;
+        std::unordered_map<crypto::Digest, uint32_t> reference;
+        uint32_t value = 0;
+        for (const auto& [insert, byte] : ops) {
+            crypto::Digest key = {0};
+            key[31] = byte;
+            if (insert) {
+                RC_ASSERT(flat.try_emplace(key, value).second == reference.try_emplace(key, value).second);
+                ++value;
+            } else {
+                RC_ASSERT(flat.erase(key) == reference.erase(key));
+            }
+            RC_ASSERT(flat.size() == reference.size());
+        }
+
+        size_t visited = 0;
+        for (const auto& [key, v] : flat) {
+            auto it = reference.find(key);
+            RC_ASSERT(it != reference.end());
+            RC_ASSERT(it->second == v);
+            ++visited;
+        }
+        RC_ASSERT(visited == reference.size());
+    });
+}
+
+/**
+ * Property: The channel neither loses nor repeats values under contention
+ *
+ * Several producers send numbered values in batches through a small ring
+ * while several consumers take them out in batches. Every value arrives
+ * exactly once, and each consumer sees any one producer's values in the
+ * order they were sent.
+ */
+void test_channel_mpmc_batches() {
+    rc::check("Channel delivers every value once and in order per producer", []() {
+        const size_t producers = *rc::gen::inRange<size_t>(1, 5);
+        const size_t consumers = *rc::gen::inRange<size_t>(1, 5);
+        const size_t per_producer = *rc::gen::inRange<size_t>(1, 2000);
+        const size_t batch = *rc::gen::inRange<size_t>(1, 17);
+        utils::Channel<uint64_t> channel(*rc::gen::inRange<size_t>(2, 64));
+
+        std::vector<std::vector<uint64_t>> received(consumers);
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&, c] {
+                std::vector<uint64_t> out(batch);
+                while (size_t count = channel.receive_batch(out)) {
+                    received[c].insert(received[c].end(), out.begin(), out.begin() + count);
+                }
+            });
+        }
+        std::vector<std::thread> senders;
+        for (uint64_t p = 0; p < producers; ++p) {
+            senders.emplace_back([&, p] {
+                std::vector<uint64_t> values;
+                for (uint64_t i = 0; i < per_producer; ++i) {
+                    values.push_back(p << 32 | i);
+                    if (values.size() == batch || i + 1 == per_producer) {
+                        channel.send_batch(values);
+                        values.clear();
+                    }
+                }
+            });
+        }
+        for (auto& sender : senders) sender.join();
+        channel.close();
+        for (auto& thread : threads) thread.join();
+
+        std::vector<uint64_t> all;
+        for (const auto& values : received) {
+            std::vector<std::optional<uint64_t>> last(producers);
+            for (uint64_t value : values) {
+                const size_t p = value >> 32;
+                RC_ASSERT(!last[p] || *last[p] < value);
+                last[p] = value;
+            }
+            all.insert(all.end(), values.begin(), values.end());
+        }
+        std::sort(all.begin(), all.end());
+        RC_ASSERT(all.size() == producers * per_producer);
+        RC_ASSERT(std::adjacent_find(all.begin(), all.end()) == all.end());
+    });
+}
+
+/**
+ * Property: close() releases parked senders and receivers
+ *
+ * Senders blocked on a full ring and receivers blocked on an empty one
+ * park once they have spun. Closing each channel wakes them: the senders
+ * give up without queueing, the receivers get nothing, and what was queued
+ * before the close still drains.
+ */
+void test_channel_close_wakes_parked() {
+    rc::check("Channel close wakes parked senders and receivers", []() {
+        const size_t waiters = *rc::gen::inRange<size_t>(1, 5);
+        utils::Channel<uint64_t> full(*rc::gen::inRange<size_t>(2, 16));
+        utils::Channel<uint64_t> empty;
+        for (uint64_t i = 0; i < full.capacity(); ++i) full.send(i);
+
+        std::atomic<size_t> returned{0};
+        std::atomic<size_t> received{0};
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < waiters; ++i) {
+            threads.emplace_back([&] {
+                full.send(full.capacity());
+                returned.fetch_add(1);
+            });
+            threads.emplace_back([&] {
+                if (empty.receive()) received.fetch_add(1);
+                returned.fetch_add(1);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        RC_ASSERT(returned.load() == 0u);
+
+        full.close();
+        empty.close();
+        for (auto& thread : threads) thread.join();
+        RC_ASSERT(returned.load() == 2 * waiters);
+        RC_ASSERT(received.load() == 0u);
+        for (uint64_t i = 0; i < full.capacity(); ++i) RC_ASSERT(full.receive() == std::optional<uint64_t>(i));
+        RC_ASSERT(!full.receive());
+    });
+}
+
+/**
+ * Property: The ring wraps around at capacity
+ *
+ * Values pass through a channel held near full for many times its capacity,
+ * so every cell is reused across laps. They come out in the order sent and
+ * the depth never passes the capacity.
+ */
+void test_channel_wraps_at_capacity() {
+    rc::check("Channel stays FIFO across laps of the ring", []() {
+        utils::Channel<uint64_t> channel(*rc::gen::inRange<size_t>(2, 64));
+        const size_t capacity = channel.capacity();
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+
+        uint64_t sent = 0;
+        uint64_t next = 0;
+        std::vector<uint64_t> out(capacity);
+        while (next < 8 * capacity) {
+            std::vector<uint64_t> values(rng() % (capacity + 1));
+            std::iota(values.begin(), values.end(), sent);
+            sent += channel.try_send_batch(values);
+            RC_ASSERT(channel.size() == sent - next);
+            RC_ASSERT(channel.size() <= capacity);
+
+            const size_t count = channel.try_receive_batch(std::span(out).first(rng() % (capacity + 1)));
+            for (size_t i = 0; i < count; ++i) RC_ASSERT(out[i] == next++);
+        }
+    });
+}
+
+/**
+ * Property: try_send_batch stops at a full ring
+ *
+ * A batch larger than the free room sends only the leading values that
+ * fit, a full ring takes none, and the rest fit again once consumers make
+ * room, still in order.
+ */
+void test_channel_try_send_batch_full() {
+    rc::check("Channel try_send_batch sends only what fits", []() {
+        utils::Channel<uint64_t> channel(*rc::gen::inRange<size_t>(2, 64));
+        const size_t capacity = channel.capacity();
+        std::vector<uint64_t> values(capacity + *rc::gen::inRange<size_t>(1, 64));
+        std::iota(values.begin(), values.end(), 0);
+
+        RC_ASSERT(channel.try_send_batch(values) == capacity);
+        RC_ASSERT(channel.size() == capacity);
+        RC_ASSERT(channel.try_send_batch(std::span<const uint64_t>(values).subspan(capacity)) == 0u);
+
+        const size_t freed = *rc::gen::inRange<size_t>(1, capacity + 1);
+        std::vector<uint64_t> out(freed);
+        RC_ASSERT(channel.try_receive_batch(out) == freed);
+        const auto rest = std::span<const uint64_t>(values).subspan(capacity);
+        const size_t refilled = channel.try_send_batch(rest);
+        RC_ASSERT(refilled == std::min(freed, rest.size()));
+
+        std::vector<uint64_t> drained(capacity);
+        drained.resize(channel.try_receive_batch(drained));
+        RC_ASSERT(drained.size() == capacity - freed + refilled);
+        for (size_t i = 0; i < drained.size(); ++i) RC_ASSERT(drained[i] == freed + i);
+    });
+}
+
+/**
+ * Property: The channel throttle has hysteresis
+ *
+ * The throttle goes up on the send that reaches the high watermark and
+ * stays up until consumers drain the channel to the low watermark. A
+ * producer calling throttle() in between blocks, is released by that
+ * drain, and is counted as a stall.
+ */
+void test_channel_throttle_watermarks() {
+    rc::check("Channel throttles from the high watermark down to the low one", []() {
+        const size_t capacity = 64;
+        const size_t high = *rc::gen::inRange<size_t>(2, capacity + 1);
+        // A watermark of 0 picks the default.
+        const size_t low = *rc::gen::inRange<size_t>(1, high);
+        utils::Channel<uint64_t> channel(capacity, high, low);
+
+        for (uint64_t i = 0; i + 1 < high; ++i) channel.send(i);
+        RC_ASSERT(!channel.throttled());
+        channel.throttle();
+        channel.send(high);
+        RC_ASSERT(channel.throttled());
+
+        std::atomic<bool> released{false};
+        std::thread producer([&] {
+            channel.throttle();
+            released.store(true);
+        });
+        std::vector<uint64_t> out(1);
+        bool held = true;
+        while (channel.size() > low + 1) {
+            channel.try_receive_batch(out);
+            held = held && channel.throttled();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const bool waited = !released.load();
+
+        channel.try_receive_batch(out);
+        producer.join();
+        RC_ASSERT(held);
+        RC_ASSERT(waited);
+        RC_ASSERT(!channel.throttled());
+        RC_ASSERT(channel.stats().stalls == 1u);
+        RC_ASSERT(channel.stats().stall_time > std::chrono::nanoseconds(0));
+    });
+}
+
+/**
+ * Property: A connection's write queue is bounded in bytes
+ *
+ * It turns congested on the push that reaches the high watermark and
+ * clears only on the pop that brings it down to the low one. A frame that
+ * would pass capacity is refused unless the queue is empty.
+ */
+void test_write_queue_limits() {
+    rc::check("WriteQueue refuses frames at capacity and flips at both marks", []() {
+        network::WriteLimits limits;
+        limits.capacity = *rc::gen::inRange<size_t>(64, 4096);
+        limits.high_watermark = *rc::gen::inRange<size_t>(2, limits.capacity + 1);
+        limits.low_watermark = *rc::gen::inRange<size_t>(0, limits.high_watermark);
+        network::WriteQueue queue(limits);
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+
+        // A frame larger than the capacity still goes out on its own.
+        RC_ASSERT(queue.push(std::make_shared<const std::vector<uint8_t>>(limits.capacity + 1)));
+        RC_ASSERT(queue.congested());
+        RC_ASSERT(!queue.push(std::make_shared<const std::vector<uint8_t>>(1)));
+        queue.pop();
+        RC_ASSERT(!queue.congested());
+
+        bool congested = false;
+        for (int step = 0; step < 200; ++step) {
+            if (rng() % 2 && !queue.empty()) {
+                queue.pop();
+                if (queue.bytes() <= limits.low_watermark) congested = false;
+            } else {
+                const size_t size = 1 + rng() % (limits.capacity / 4);
+                const size_t before = queue.bytes();
+                const bool fits = before + size <= limits.capacity || queue.empty();
+                RC_ASSERT(queue.push(std::make_shared<const std::vector<uint8_t>>(size)) == fits);
+                RC_ASSERT(queue.bytes() == (fits ? before + size : before));
+                if (queue.bytes() >= limits.high_watermark) congested = true;
+            }
+            RC_ASSERT(queue.congested() == congested);
+            RC_ASSERT(queue.bytes() <= limits.capacity);
+        }
+    });
+}
+
 /**
  * Property: Quorum intersection
  * 
@@ -161,12 +1003,251 @@ void test_serialization_roundtrip() {
         auto original = *rc::gen::arbitrary<consensus::Certificate>();
         auto serialized = original.serialize();
         
-        // TODO: Implement Certificate::deserialize()
-        // auto deserialized = consensus::Certificate::deserialize(serialized);
-        // RC_ASSERT(original.digest() == deserialized.digest());
-        
-        // For now, just check serialization doesn't crash
-        RC_ASSERT(!serialized.empty());
+        auto deserialized = consensus::Certificate::deserialize(serialized);
+        RC_ASSERT(original.digest() == deserialized.digest());
+        RC_ASSERT(original.votes == deserialized.votes);
+        RC_ASSERT(original.header().parents == deserialized.header().parents);
+        RC_ASSERT(original.header().payload == deserialized.header().payload);
+
+        auto view = consensus::CertificateView::parse(serialized);
+        RC_ASSERT(view.digest() == original.digest());
+        RC_ASSERT(view.origin() == original.origin());
+        RC_ASSERT(view.round() == original.round());
+        RC_ASSERT(view.header().parent_count() == original.header().parents.size());
+        RC_ASSERT(view.signature_count() == original.votes.signatures().size());
+    });
+}
+
+/**
+ * Property: A recorded log replays the same input
+ *
+ * Certificates handed to a Recorder load back from its file in order, with
+ * their arrival offsets and the committee they were recorded under.
+ */
+void test_record_replay_roundtrip() {
+    rc::check("Recorder output loads back as recorded", []() {
+        const auto committee = make_committee(*rc::gen::inRange<size_t>(4, 8));
+        std::mt19937_64 rng(*rc::gen::inRange<uint64_t>(0, UINT64_MAX));
+        const auto certificates = random_dag(committee, *rc::gen::inRange<consensus::Round>(1, 8), rng);
+        const auto path = (std::filesystem::temp_directory_path() / "narwhal_property_tests.nrpl").string();
+
+        std::vector<std::chrono::nanoseconds> offsets;
+        {
+            consensus::Recorder recorder(path, committee);
+            const auto start = consensus::Recorder::Clock::now();
+            std::chrono::nanoseconds offset{0};
+            for (const auto& cert : certificates) {
+                offsets.push_back(offset);
+                recorder.record(cert, start + offset);
+                offset += std::chrono::nanoseconds(rng() % 1000000);
+            }
+        }
+
+        auto log = consensus::ReplayLog::load(path);
+        std::filesystem::remove(path);
+        RC_ASSERT(log.committee.size() == committee.size());
+        for (config::Committee::Index i = 0; i < committee.size(); ++i) {
+            RC_ASSERT(log.committee.key(i) == committee.key(i));
+        }
+        RC_ASSERT(log.entries.size() == certificates.size());
+        for (size_t i = 0; i < certificates.size(); ++i) {
+            RC_ASSERT(log.entries[i].offset == offsets[i]);
+            RC_ASSERT(log.entries[i].certificate->digest() == certificates[i]->digest());
+        }
+    });
+}
+
+/**
+ * Property: Payloads are canonical
+ *
+ * The same entries in any order make equal payloads, and so headers that
+ * encode to the same bytes and certificates with the same digest.
+ */
+void test_payload_canonical() {
+    rc::check("Payload encoding does not depend on insertion order", []() {
+        auto workers = *rc::gen::container<std::map<uint8_t, uint32_t>>(
+            rc::gen::pair(rc::gen::arbitrary<uint8_t>(), rc::gen::inRange<uint32_t>(0, 4)));
+
+        std::vector<consensus::Payload::Entry> entries;
+        for (auto [id, worker] : workers) {
+            crypto::Digest digest = {0};
+            digest[0] = id;
+            entries.push_back({digest, worker});
+        }
+        consensus::Header forward, backward;
+        forward.payload = consensus::Payload(entries);
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+            RC_ASSERT(backward.payload.insert(it->digest, it->worker));
+        }
+
+        RC_ASSERT(forward.serialize() == backward.serialize());
+        for (const auto& entry : entries) {
+            RC_ASSERT(forward.payload.worker_of(entry.digest) == std::optional<uint32_t>(entry.worker));
+        }
+    });
+}
+
+/**
+ * Property: Votes keep signatures in signer order and aggregate soundly
+ *
+ * However signers are added, signatures end up in committee index order,
+ * the encoding round-trips, and the aggregate verifies against exactly
+ * the signers' keys.
+ */
+void test_votes_aggregate() {
+    rc::check("Votes are index-ordered and their aggregate verifies", []() {
+        auto width = *rc::gen::inRange<size_t>(1, 130);
+        auto order = *rc::gen::container<std::vector<uint32_t>>(rc::gen::inRange<uint32_t>(0, 130));
+        const std::vector<uint8_t> message = {1, 2, 3};
+        auto key = [](uint32_t index) {
+            crypto::PublicKey pk = {0};
+            std::memcpy(pk.data(), &index, sizeof(index));
+            return pk;
+        };
+
+        consensus::Votes votes(width);
+        for (auto signer : order) {
+            if (signer < width) votes.add(signer, crypto::InsecureAggregate::sign(message, key(signer)));
+        }
+        std::vector<crypto::PublicKey> signers;
+        votes.signers().for_each([&](size_t signer) { signers.push_back(key(static_cast<uint32_t>(signer))); });
+        for (size_t i = 0; i < signers.size(); ++i) {
+            RC_ASSERT(votes.signatures()[i] == crypto::InsecureAggregate::sign(message, signers[i]));
+        }
+
+        crypto::InsecureAggregate scheme;
+        auto aggregated = votes.aggregate(scheme);
+        for (const auto& encoded : {votes, aggregated}) {
+            auto bytes = encoded.serialize();
+            utils::Unpacker unpacker(bytes);
+            RC_ASSERT(consensus::Votes::deserialize(unpacker) == encoded);
+        }
+        RC_ASSERT(scheme.verify(message, aggregated.signatures()[0], signers) == !signers.empty());
+        if (!signers.empty()) {
+            signers.pop_back();
+            RC_ASSERT(!scheme.verify(message, aggregated.signatures()[0], signers));
+        }
+    });
+}
+
+/**
+ * Property: Compact certificates expand to the full encoding
+ *
+ * With the previous round in the slot table, the compact form expands to
+ * exactly the bytes the digest was taken over, whichever parents it could
+ * compress. Against a table holding another certificate in a compressed
+ * parent's slot it does not expand at all.
+ */
+void test_compact_certificate_roundtrip() {
+    rc::check("Compact certificates expand to the full encoding", []() {
+        auto width = *rc::gen::inRange<size_t>(1, 70);
+        auto chosen = *rc::gen::container<std::vector<uint32_t>>(rc::gen::inRange<uint32_t>(0, 70));
+
+        std::map<crypto::PublicKey, config::Authority> authorities;
+        for (uint32_t i = 0; i < width; ++i) {
+            crypto::PublicKey pk = {0};
+            std::memcpy(pk.data(), &i, sizeof(i));
+            authorities[pk] = {1, "", ""};
+        }
+        config::Committee committee(authorities);
+        consensus::SlotTable slots(committee, 4);
+        std::vector<crypto::Digest> previous;
+        for (config::Committee::Index i = 0; i < width; ++i) {
+            consensus::Header header;
+            header.author = committee.key(i);
+            header.round = 1;
+            consensus::Certificate certificate(header);
+            slots.insert(certificate);
+            previous.push_back(certificate.digest());
+        }
+
+        consensus::Header header;
+        header.author = committee.key(0);
+        header.round = 2;
+        for (auto i : chosen) {
+            header.parents.push_back(i < width ? previous[i] : crypto::Digest{static_cast<uint8_t>(i)});
+        }
+        consensus::Certificate certificate(header);
+
+        consensus::CompactCertificate encoded(certificate, slots);
+        auto compact = encoded.serialize();
+        std::vector<uint8_t> full;
+        RC_ASSERT(consensus::expand_compact(compact, slots, full));
+        RC_ASSERT(full == certificate.serialize());
+
+        if (encoded.compressed() == 0) return;
+        consensus::SlotTable forged(committee, 4);
+        for (config::Committee::Index i = 0; i < width; ++i) {
+            forged.insert(1, i, i == chosen[0] ? crypto::Digest{0xff} : previous[i]);
+        }
+        RC_ASSERT(!consensus::expand_compact(compact, forged, full));
+    });
+}
+
+/**
+ * Property: Views reject truncated input
+ *
+ * Every proper prefix of an encoded certificate fails to parse, so the
+ * inbound path never reads past a short message.
+ */
+void test_certificate_view_rejects_truncation() {
+    rc::check("CertificateView rejects truncated input", []() {
+        auto serialized = (*rc::gen::arbitrary<consensus::Certificate>()).serialize();
+        auto length = *rc::gen::inRange<size_t>(0, serialized.size());
+        bool rejected = false;
+        try {
+            consensus::CertificateView::parse(std::span<const uint8_t>(serialized.data(), length));
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        RC_ASSERT(rejected);
+    });
+}
+
+/**
+ * Property: The inbound filter holds a slot only for verified certificates
+ *
+ * A forgery for an author and round passes the filter but, failing
+ * verification, is never recorded, so the genuine certificate still gets
+ * through; after that the round is a duplicate for that author. Rounds
+ * below the local floor or past the window are refused whatever peers send.
+ */
+void test_inbound_filter() {
+    rc::check("InboundFilter refuses stale, duplicate and out-of-window rounds", []() {
+        const auto committee = make_committee(4);
+        const consensus::Round window = *rc::gen::inRange<consensus::Round>(1, 64);
+        const consensus::Round floor = *rc::gen::inRange<consensus::Round>(0, 1000);
+        const consensus::Round round = floor + *rc::gen::inRange<consensus::Round>(0, window + 1);
+        const auto author = *rc::gen::inRange<config::Committee::Index>(0, 4);
+        consensus::InboundFilter filter(committee, window);
+        filter.advance(floor);
+
+        auto make = [&](consensus::Round at, uint8_t tag) {
+            consensus::Header header;
+            header.author = committee.key(author);
+            header.round = at;
+            header.payload.insert(crypto::Digest{tag}, 0);
+            return consensus::Certificate(std::move(header));
+        };
+        auto accept = [&](const consensus::Certificate& certificate) {
+            auto bytes = certificate.serialize();
+            return filter.accept(consensus::CertificateView::parse(bytes));
+        };
+
+        const auto forged = make(round, 1);
+        const auto genuine = make(round, 2);
+        RC_ASSERT(accept(forged));
+        RC_ASSERT(accept(genuine));
+        RC_ASSERT(filter.record(genuine));
+        RC_ASSERT(!accept(genuine));
+        RC_ASSERT(!accept(forged));
+        RC_ASSERT(!filter.record(forged));
+
+        RC_ASSERT(!accept(make(floor + window + 1, 3)));
+        RC_ASSERT(!accept(make(UINT64_MAX, 3)));
+        filter.advance(round + 1);
+        RC_ASSERT(!accept(make(round, 3)));
+        RC_ASSERT(accept(make(round + 1, 3)));
     });
 }
 
@@ -181,18 +1262,93 @@ int main() {
         test_certificate_digest_deterministic();
         std::cout << "✓ Certificate digest determinism" << std::endl;
         
+        test_certificate_digest_cached();
+        std::cout << "✓ Certificate digest caching" << std::endl;
+        
         test_mysticeti_round_monotonicity();
         std::cout << "✓ Mysticeti round monotonicity" << std::endl;
         
+        test_mysticeti_commits_once();
+        std::cout << "✓ Mysticeti commits once" << std::endl;
+        
+        test_flat_hash_map_matches_unordered_map();
+        std::cout << "✓ FlatHashMap matches std::unordered_map" << std::endl;
+        
+        test_commit_order_independent();
+        std::cout << "✓ Commit order independence" << std::endl;
+        
+        test_shoal_direct_commit();
+        std::cout << "✓ Shoal++ direct commit" << std::endl;
+        
+        test_shoal_indirect_commit();
+        std::cout << "✓ Shoal++ indirect commit" << std::endl;
+        
+        test_shoal_reputation_reschedule();
+        std::cout << "✓ Shoal++ reputation reschedule" << std::endl;
+        
+        test_batched_ingestion_matches_unbatched();
+        std::cout << "✓ Batched ingestion" << std::endl;
+        
+        test_executor_pipeline_single_thread();
+        std::cout << "✓ Executor pipeline on one worker" << std::endl;
+        
+        test_shadow_identical_engines_agree();
+        std::cout << "✓ Shadow agreement" << std::endl;
+        
+        test_shadow_different_engines_diverge();
+        std::cout << "✓ Shadow divergence" << std::endl;
+        
+        test_shadow_arrivals_bounded();
+        std::cout << "✓ Shadow arrivals bounded" << std::endl;
+        
+        test_dag_bounds_lookahead();
+        std::cout << "✓ DAG lookahead bound" << std::endl;
+        
         test_no_equivocation();
         std::cout << "✓ No equivocation" << std::endl;
         
+        test_channel_mpmc_batches();
+        std::cout << "✓ Channel MPMC batches" << std::endl;
+        
+        test_channel_close_wakes_parked();
+        std::cout << "✓ Channel close wakes parked threads" << std::endl;
+        
+        test_channel_wraps_at_capacity();
+        std::cout << "✓ Channel wrap-around" << std::endl;
+        
+        test_channel_try_send_batch_full();
+        std::cout << "✓ Channel try_send_batch on a full ring" << std::endl;
+        
+        test_channel_throttle_watermarks();
+        std::cout << "✓ Channel throttle watermarks" << std::endl;
+        
+        test_write_queue_limits();
+        std::cout << "✓ Write queue limits" << std::endl;
+        
         test_quorum_intersection();
         std::cout << "✓ Quorum intersection" << std::endl;
         
         test_serialization_roundtrip();
         std::cout << "✓ Serialization round-trip" << std::endl;
         
+        test_record_replay_roundtrip();
+        std::cout << "✓ Record/replay round-trip" << std::endl;
+        
+        test_payload_canonical();
+        std::cout << "✓ Payload canonical encoding" << std::endl;
+        
+        test_votes_aggregate();
+        std::cout << "✓ Votes ordering and aggregation" << std::endl;
+        
+        test_compact_certificate_roundtrip();
+        std::cout << "✓ Compact certificate round-trip" << std::endl;
+        
+        test_certificate_view_rejects_truncation();
+        std::cout << "✓ CertificateView truncation" << std::endl;
+        
+        test_inbound_filter();
+        std::cout << "✓ Inbound filter" << std::endl;
+        
         std::cout << "\n✅ All property tests passed!" << std::endl;
         return 0;
         